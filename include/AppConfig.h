@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <Boundary.h>
+
+enum class SimulationEngine
+{
+	Gpu,        // fragment shader ping-pong on the render thread
+	Cpu,        // bit-sliced CPU rule on its own thread
+};
+
+// what happens once the board repeats itself (CPU engine)
+enum class CycleAction
+{
+	Off,
+	Report,         // print the generation and period, keep running
+	Stop,           // also stop stepping
+	FastForward,    // --bench: skip straight to the last generation using the period; otherwise as Stop
+};
+
+// board sizes --size accepts; files loaded at startup are held to the same range
+const unsigned int MIN_BOARD_SIZE = 3;
+const unsigned int MAX_BOARD_SIZE = 1u << 20;
+
+// Runtime settings, filled from the command line.
+struct AppConfig
+{
+	bool showHelp = false;
+
+	SimulationEngine engine = SimulationEngine::Gpu;
+
+	// pacing
+	double generationsPerSecond = 10.0;     // 0 = unlimited
+	unsigned maxCatchUp = 0;                // extra steps run to catch up after a stall, 0 drops late steps
+
+	// display
+	double fullUploadFraction = 0.25;       // CPU engine: upload the whole board when more tiles than this changed
+	size_t gpuTileSize = 0;                 // GPU engine: cells per simulation tile side, 0 = automatic
+	bool ageColors = false;                 // GPU engine: track cell ages and colour live cells by age
+
+	// cycle detection
+	CycleAction cycleAction = CycleAction::Off;
+
+	// statistics
+	std::string statsPath;                  // per-generation population/births/deaths/bounds, .csv or binary, empty disables
+
+	// board
+	unsigned int boardWidth = 256;
+	unsigned int boardHeight = 256;
+	uint64_t seed = 0;                      // 0 picks a random seed
+	Boundary boundary = Boundary::Dead;     // what lies beyond the edges, for both engines
+	bool growBoard = false;                 // CPU engine, dead boundary: grow the board with the pattern
+	bool shrinkBoard = false;               // with growBoard, also shrink it when the pattern contracts
+
+	// headless benchmark
+	uint64_t benchmarkGenerations = 0;      // run this many generations without a window, 0 = interactive
+	size_t gpuBatchBoards = 0;              // step this many boards together on the GPU instead, 0 = off
+	bool benchmarkCounters = false;         // also collect hardware performance counters
+
+	// soup search
+	uint64_t soupCount = 0;                 // run this many random soups without a window and print a census, 0 = off
+	unsigned soupThreads = 0;               // worker threads, 0 = one per hardware thread
+	std::string censusPath;                 // also write the full census as CSV here
+	std::string patternStorePath;           // add the still lifes and oscillators found to this PatternStore file
+	unsigned objectDistance = 1;            // cells at most this far apart form one object (1 = 8-connected)
+	bool benchmarkObjects = false;          // --bench: also split the final board into objects
+
+	// terminal output
+	bool terminal = false;                  // draw to the terminal with the CPU engine instead of opening a window
+	double terminalFps = 15.0;              // terminal frames per second
+
+	// checkpointing
+	uint64_t checkpointInterval = 0;        // generations between checkpoints, 0 disables
+	std::string checkpointDirectory = "checkpoints";
+	size_t checkpointMaxPending = 2;        // snapshots queued for the writer before dropping
+	std::string resumeFrom;                 // checkpoint file to start from
+
+	// history recording
+	std::string recordPath;                 // record every generation to this file, empty disables
+	uint64_t keyframeInterval = 64;         // frames between keyframes
+	std::string replayPath;                 // open this recorded history in the viewer instead of a new board
+
+	// rewind
+	uint64_t rewindInterval = 16;           // generations between stored rewind frames
+	size_t rewindMemoryMiB = 64;            // memory budget for the rewind buffer, 0 disables
+
+	// metrics
+	double metricsInterval = 5.0;           // seconds between latency reports, 0 = only at shutdown
+
+	// tracing
+	std::string tracePath;                  // trace from startup and write Chrome JSON here on exit
+};
+
+// throws std::runtime_error on malformed arguments
+AppConfig ParseCommandLine(int argc, char** argv);
+
+void PrintUsage();
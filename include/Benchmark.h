@@ -0,0 +1,8 @@
+#pragma once
+
+#include <AppConfig.h>
+
+// Headless run: steps a seeded board config.benchmarkGenerations times with the CPU rule
+// and reports generations/sec, ns/cell and, if requested and available, hardware counters.
+// Returns the process exit code.
+int RunBenchmark(const AppConfig& config);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bit-packed board: one bit per cell, rows padded to whole 64-bit words.
+// Bit x % 64 of word x / 64 holds cell x. Padding bits past the width are always zero.
+class BitGrid
+{
+public:
+	BitGrid() = default;
+	BitGrid(size_t width, size_t height);
+
+	void Resize(size_t width, size_t height);
+	void Clear();
+
+	size_t Width() const { return width; }
+	size_t Height() const { return height; }
+	size_t WordsPerRow() const { return wordsPerRow; }
+
+	// mask of the valid bits in the last word of each row
+	uint64_t LastWordMask() const;
+
+	bool Get(size_t x, size_t y) const {
+		return (words[y * wordsPerRow + x / 64] >> (x % 64)) & 1ull;
+	}
+
+	void Set(size_t x, size_t y, bool alive) {
+		uint64_t& word = words[y * wordsPerRow + x / 64];
+		const uint64_t bit = 1ull << (x % 64);
+		word = alive ? (word | bit) : (word & ~bit);
+	}
+
+	uint64_t* Row(size_t y) { return words.data() + y * wordsPerRow; }
+	const uint64_t* Row(size_t y) const { return words.data() + y * wordsPerRow; }
+
+	std::vector<uint64_t>& Words() { return words; }
+	const std::vector<uint64_t>& Words() const { return words; }
+
+	uint64_t Population() const;
+
+	// conversion to/from the float layout used by the simulation textures
+	void FromFloatGrid(const std::vector<float>& grid);
+	void ToFloatGrid(std::vector<float>& grid) const;
+
+	bool operator==(const BitGrid& other) const {
+		return width == other.width && height == other.height && words == other.words;
+	}
+	bool operator!=(const BitGrid& other) const { return !(*this == other); }
+
+private:
+	size_t width = 0, height = 0;
+	size_t wordsPerRow = 0;
+	std::vector<uint64_t> words;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <BitGrid.h>
+#include <Boundary.h>
+#include <Shader.h>
+
+// Steps many independent boards of the same size at once, for ensembles and parameter
+// sweeps where one small board would leave the GPU idle. The boards are bit-packed across an
+// RGBA32UI texture: every texel holds one cell of BOARDS_PER_TEXTURE boards, so a single draw
+// steps all of them with bitwise adders and every texel fetch serves 128 boards. More boards
+// take more textures, one draw each.
+// Per-board populations are reduced on the GPU in two passes (bit-sliced counts per row
+// segment, then per board and band of rows) and read back asynchronously like the stats of
+// SimulationShader; only a few integers per board cross the bus.
+class BoardBatchShader : public Shader
+{
+public:
+	static const size_t BOARDS_PER_TEXTURE = 128;
+
+	explicit BoardBatchShader(const char* vertexPath, Boundary boundary = Boundary::Dead);
+
+	~BoardBatchShader();
+
+	BoardBatchShader(const BoardBatchShader&) = delete;
+	BoardBatchShader& operator=(const BoardBatchShader&) = delete;
+
+	void Initialize(size_t width, size_t height, size_t boards);
+
+	size_t Boards() const { return boards; }
+
+	// boards[i] becomes board i; every board must have the size given to Initialize
+	void ProvideBoards(const std::vector<BitGrid>& boards);
+
+	// copies board out of its texture; waits for the GPU, so meant for checks and results,
+	// not for every generation
+	void ReadBoard(size_t board, BitGrid& grid);
+
+	void RunSimulation();
+
+	// Starts reducing the populations of all boards of the current generation. Returns false
+	// if every slot is busy. The reduction resources are created on first use.
+	bool RequestPopulations(uint64_t generation);
+
+	// completes the oldest pending request into populations (one per board); wait blocks
+	// until the GPU has finished it
+	bool PollPopulations(uint64_t& generation, std::vector<uint64_t>& populations, bool wait = false);
+
+	bool HasPendingPopulations() const { return populationCount > 0; }
+
+private:
+	static const size_t POPULATION_SLOTS = 4;
+	// must match batch_count.frag and batch_sum.frag
+	static const size_t COUNT_SEGMENT = 128;
+	static const size_t COUNT_PLANES = 8;
+	static const size_t SUM_ROWS = 16;
+
+	struct Readback {
+		GLuint PBO = 0;
+		GLsync fence = nullptr;
+		uint64_t generation = 0;
+	};
+
+	// BOARDS_PER_TEXTURE boards, ping-pong
+	struct Batch {
+		GLuint textures[2] = { 0, 0 };
+		GLuint FBOs[2] = { 0, 0 };
+	};
+
+	GLuint VAO = 0, VBO = 0, EBO = 0;
+
+	size_t width = 0, height = 0, boards = 0;
+	std::vector<Batch> batches;
+	// index of the textures holding the current generation, the same for every batch
+	size_t current = 0;
+
+	Shader countShader;
+	Shader sumShader;
+	GLuint countFBO = 0, countPlanes = 0;   // bit-sliced segment counts, one layer per plane
+	GLuint sumFBO = 0, sumTexture = 0;      // one column per board, one row per band of SUM_ROWS
+	size_t segments = 0, bands = 0;
+	std::array<Readback, POPULATION_SLOTS> populationSlots;
+	size_t populationHead = 0, populationCount = 0;
+
+	void createQuad();
+
+	void createPopulationResources();
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <BitGrid.h>
+#include <BoardStats.h>
+
+// Keeps a dense board just large enough for a growing pattern, so spacefillers and breeders run
+// at full BitGrid speed without guessing the board size up front. After every step the live
+// cells' bounding box is checked against the edges (it comes out of the stepping pass, so the
+// check is free); when it came within MARGIN cells of one, that side grows by whole chunks,
+// leaving a chunk of room, and the board is reallocated with the cells copied across. Chunks
+// are 64 cells, a word across and a DirtyTiles tile high, so the copy moves whole words.
+// Optionally a side shrinks back when more than SHRINK_SLACK cells past that room are empty.
+// Only meaningful with a dead boundary: MARGIN keeps the live cells off the dead ring.
+class BoardGrowth
+{
+public:
+	static const size_t CHUNK = 64;
+	// a pattern grows at most one cell per generation, so two cells keep it off the dead ring
+	static const size_t MARGIN = 2;
+	static const size_t SHRINK_SLACK = 2 * CHUNK;
+	// per side; beyond it the board stops growing and the dead ring applies again
+	static const size_t MAX_SIZE = 1 << 16;
+
+	// disabled
+	BoardGrowth() = default;
+
+	explicit BoardGrowth(bool shrink) : enabled(true), shrink(shrink) {}
+
+	bool Enabled() const { return enabled; }
+
+	// Resizes grid if its live cells (bounded by the box in stats) need it; returns whether it
+	// did. The box in stats moves along with the cells.
+	bool Fit(BitGrid& grid, BoardStats& stats);
+
+	// position of cell (0, 0) on the starting board; moves by whole chunks as the board grows
+	// or shrinks on the left and bottom
+	int64_t OriginX() const { return originX; }
+	int64_t OriginY() const { return originY; }
+
+	uint64_t Resizes() const { return resizes; }
+
+private:
+	bool enabled = false;
+	bool shrink = false;
+	int64_t originX = 0, originY = 0;
+	uint64_t resizes = 0;
+	BitGrid resized;
+
+	// cells a side with the live cells distance away from it gains (negative: loses)
+	int64_t sideChange(int64_t distance) const;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <BitGrid.h>
+
+// 64-bit board fingerprint in the spirit of Zobrist hashing, with whole words as the keys:
+// the sum over all words of a mixed (word, index) pair, with empty words contributing nothing.
+// Because it is a sum, a changed word updates it in O(1). LifeRule::Step keeps it up to date
+// from the words it sees flip, so a running board is fingerprinted at the cost of its changes.
+namespace BoardHash
+{
+	inline uint64_t Word(size_t index, uint64_t word) {
+		if (word == 0) {
+			return 0;
+		}
+		// splitmix64 finalizer over the word keyed by its position
+		uint64_t x = word ^ (uint64_t(index) * 0x9E3779B97F4A7C15ull);
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+
+	inline uint64_t Full(const BitGrid& grid) {
+		uint64_t hash = 0;
+		const std::vector<uint64_t>& words = grid.Words();
+		for (size_t i = 0; i < words.size(); i++) {
+			hash += Word(i, words[i]);
+		}
+		return hash;
+	}
+
+	// hash after word index changed from before to after
+	inline uint64_t Replace(uint64_t hash, size_t index, uint64_t before, uint64_t after) {
+		return hash + Word(index, after) - Word(index, before);
+	}
+}
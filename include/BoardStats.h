@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include <BitGrid.h>
+
+// Per-generation summary of a board. births and deaths count the cells that changed since the
+// previous generation; the bounding box is inclusive and only meaningful while population > 0.
+struct BoardStats
+{
+	uint64_t population = 0;
+	uint64_t births = 0;
+	uint64_t deaths = 0;
+	uint32_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+	// counts and box of grid on its own, without births or deaths
+	static BoardStats Of(const BitGrid& grid);
+
+	// adds the counts of a disjoint part of the same board and grows the box to cover it
+	void Merge(const BoardStats& part);
+};
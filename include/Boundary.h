@@ -0,0 +1,31 @@
+#pragma once
+
+// What the cells just outside the board look like to the rule. Dead keeps the outermost ring of
+// the board itself dead, as the original shader did; the others step every cell and only
+// differ in where a neighbour across the edge comes from.
+enum class Boundary
+{
+	Dead,       // the outermost ring is forced dead
+	Torus,      // left/right and top/bottom edges are joined
+	Klein,      // left/right joined; top/bottom joined with x mirrored, so gliders come back flipped
+	Mirror,     // the edge cells are reflected outwards: the cell beyond an edge equals the edge cell
+};
+
+inline const char* BoundaryName(Boundary boundary) {
+	switch (boundary) {
+	case Boundary::Torus: return "torus";
+	case Boundary::Klein: return "klein";
+	case Boundary::Mirror: return "mirror";
+	default: return "dead";
+	}
+}
+
+// the #define that selects the boundary in simulation.frag and batch_step.frag
+inline const char* BoundaryDefine(Boundary boundary) {
+	switch (boundary) {
+	case Boundary::Torus: return "#define BOUNDARY_TORUS\n";
+	case Boundary::Klein: return "#define BOUNDARY_KLEIN\n";
+	case Boundary::Mirror: return "#define BOUNDARY_MIRROR\n";
+	default: return "#define BOUNDARY_DEAD\n";
+	}
+}
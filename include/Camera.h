@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// 2D pan/zoom view onto the board. Positions on screen are window coordinates (origin top
+// left, y down, as GLFW reports the cursor); positions on the board are in cells (origin
+// bottom left, matching texture rows).
+class Camera
+{
+public:
+	static constexpr float MAX_PIXELS_PER_CELL = 64.0f;
+
+	// shows the whole board, centred
+	void Fit(const glm::vec2& boardSize, const glm::vec2& viewportSize);
+
+	// zooms by factor, keeping the cell under the screen position where it is
+	void ZoomAt(float factor, const glm::vec2& screen, const glm::vec2& viewportSize);
+
+	// moves the view by a cursor movement in screen pixels (drag semantics)
+	void Pan(const glm::vec2& screenDelta);
+
+	// follows cells that moved by delta on the board, e.g. when it grew on the left or bottom
+	void Translate(const glm::vec2& delta) { center += delta; }
+
+	glm::vec2 ScreenToCell(const glm::vec2& screen, const glm::vec2& viewportSize) const;
+
+	// board position of the bottom-left window corner and the cells spanned by the window
+	glm::vec2 ViewOrigin(const glm::vec2& viewportSize) const { return center - ViewSize(viewportSize) * 0.5f; }
+	glm::vec2 ViewSize(const glm::vec2& viewportSize) const { return viewportSize / pixelsPerCell; }
+
+	float CellsPerPixel() const { return 1.0f / pixelsPerCell; }
+
+private:
+	glm::vec2 center = glm::vec2(0.0f);
+	float pixelsPerCell = 1.0f;
+	// zoomed out far enough that the board is a few pixels wide
+	float minPixelsPerCell = 1.0f / 1024.0f;
+};
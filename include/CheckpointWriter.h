@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <GridSnapshot.h>
+
+struct CheckpointStats
+{
+	uint64_t submitted = 0;
+	uint64_t written = 0;
+	uint64_t dropped = 0;        // queue was full, snapshot discarded
+	uint64_t failed = 0;         // I/O errors
+	uint64_t bytesWritten = 0;
+	double captureSeconds = 0.0; // time spent on the step loop (readback + submit)
+	double writeSeconds = 0.0;   // time spent on the writer thread
+};
+
+// Writes snapshots to disk on a background thread so the step loop never waits on I/O.
+// At most maxPending snapshots are queued; further submissions are dropped rather than
+// stalling the caller, which bounds the memory overhead to (maxPending + 1) packed boards.
+class CheckpointWriter
+{
+public:
+	CheckpointWriter(const std::string& directory, uint64_t interval, size_t maxPending);
+
+	// drains the queue before returning
+	~CheckpointWriter();
+
+	bool Enabled() const { return interval > 0; }
+	bool IsDue(uint64_t generation) const { return interval > 0 && generation % interval == 0; }
+
+	// never blocks on I/O; returns false if the snapshot was dropped
+	bool Submit(GridSnapshotPtr snapshot);
+
+	void AddCaptureTime(double seconds);
+
+	// counts a due generation that never got as far as Submit, e.g. because its readback could not start
+	void AddDropped();
+
+	CheckpointStats Stats() const;
+	void PrintStats() const;
+
+	static bool Load(const std::string& path, GridSnapshot& snapshot);
+
+private:
+	std::string directory;
+	uint64_t interval = 0;
+	size_t maxPending = 0;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<GridSnapshotPtr> pending;
+	bool stopping = false;
+	CheckpointStats stats;
+
+	std::thread writer;
+
+	void writerLoop();
+
+	bool writeSnapshot(const GridSnapshot& snapshot, uint64_t& bytes);
+};
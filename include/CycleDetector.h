@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+#include <BitGrid.h>
+
+// Brent's cycle detection over a run of consecutive generations: a saved board is replaced
+// whenever the number of generations since it was saved reaches the next power of two, and
+// every generation is compared against it by hash (then by board, so a collision cannot stop
+// a run). Any period P is found within about 2 * max(P, transient) + P generations, keeping
+// a single board copy that is refreshed only O(log n) times.
+class CycleDetector
+{
+public:
+	// feed every generation in order; true once, for the generation where the repeat is found
+	bool Observe(uint64_t generation, uint64_t hash, const BitGrid& grid);
+
+	// start over, e.g. after the board was edited
+	void Reset();
+
+	bool Found() const { return period > 0; }
+
+	// 0 until found
+	uint64_t Period() const { return period; }
+
+	// generation at which the repeat was seen; the board is periodic from here on at the latest
+	uint64_t FoundAt() const { return foundAt; }
+
+private:
+	bool hasSaved = false;
+	uint64_t savedGeneration = 0;
+	uint64_t savedHash = 0;
+	BitGrid saved;
+
+	uint64_t power = 1;
+	uint64_t period = 0;
+	uint64_t foundAt = 0;
+
+	void save(uint64_t generation, uint64_t hash, const BitGrid& grid);
+};
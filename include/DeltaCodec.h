@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Run-length coding of bit-packed boards. A frame is a sequence of
+// (zero word run, literal word count, literal words...) tokens with varint lengths,
+// so the encoded size scales with the number of non-zero words rather than the board size.
+// Keyframes encode the board itself, delta frames encode current ^ previous.
+namespace DeltaCodec
+{
+	void EncodeWords(const uint64_t* words, size_t count, std::vector<uint8_t>& out);
+
+	void EncodeXor(const uint64_t* current, const uint64_t* previous, size_t count, std::vector<uint8_t>& out);
+
+	// XORs the decoded words into target; decoding a keyframe into a cleared board restores it.
+	// Returns false if the data is malformed or runs past count words.
+	bool DecodeXorInto(const uint8_t* data, size_t size, uint64_t* target, size_t count);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <LifeEngine.h>
+
+// Live-cell density per block at every power-of-two block size, kept in a mipmapped GL_R8
+// texture: level l holds the fraction of live cells in each (BASE_BLOCK << l)-cell square.
+// Zoomed-out views sample it with textureLod, so drawing costs the same for any board size.
+// Levels up to the tile size are recounted only inside tiles that changed (EngineFrame
+// tileVersions); the coarser levels are cheap enough to rebuild from them whenever anything did.
+class DensityPyramid
+{
+public:
+	static const size_t BASE_BLOCK = 8;
+
+	DensityPyramid() = default;
+
+	~DensityPyramid();
+
+	DensityPyramid(const DensityPyramid&) = delete;
+	DensityPyramid& operator=(const DensityPyramid&) = delete;
+
+	// brings the pyramid up to date with an engine frame
+	void Update(const EngineFrame& frame);
+
+	// recounts a board that is not part of the engine's sequence (e.g. a rewound generation)
+	void Rebuild(const BitGrid& grid);
+
+	GLuint Texture() const { return texture; }
+
+private:
+	// levels that fit inside one tile: 8, 16, 32 and 64 cell blocks
+	static const size_t TILE_LEVELS = 4;
+	static const size_t TILE_SIZE = DirtyTiles::TILE_SIZE;
+
+	struct Level {
+		size_t width = 0, height = 0;
+		std::vector<uint32_t> counts;
+		std::vector<uint8_t> density;
+	};
+
+	GLuint texture = 0;
+	std::vector<Level> levels;
+	size_t tilesX = 0, tilesY = 0;
+	bool valid = false;
+	uint64_t sequence = 0;
+
+	std::vector<uint32_t> dirtyTiles;
+
+	void allocate(const BitGrid& grid);
+	void countTile(const BitGrid& grid, size_t tileX, size_t tileY);
+	void rebuildCoarseLevels();
+	void uploadTile(size_t tileX, size_t tileY, size_t tileCount);
+	void uploadLevel(size_t level);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of changed TILE_SIZE x TILE_SIZE tiles of a board. A tile is one BitGrid word wide,
+// so marking from the stepping loop needs no bit arithmetic. Keeps both a flag per tile
+// and the list of marked tiles, so clearing and iterating cost only what was marked.
+class DirtyTiles
+{
+public:
+	static const size_t TILE_SIZE = 64;
+
+	void Resize(size_t width, size_t height) {
+		tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+		flags.assign(tilesX * tilesY, 0);
+		marked.clear();
+	}
+
+	void Clear() {
+		for (uint32_t tile : marked) {
+			flags[tile] = 0;
+		}
+		marked.clear();
+	}
+
+	void Mark(size_t tileX, size_t tileY) {
+		const size_t tile = tileY * tilesX + tileX;
+		if (!flags[tile]) {
+			flags[tile] = 1;
+			marked.push_back(uint32_t(tile));
+		}
+	}
+
+	void MarkCell(size_t x, size_t y) { Mark(x / TILE_SIZE, y / TILE_SIZE); }
+
+	size_t TilesX() const { return tilesX; }
+	size_t TilesY() const { return tilesY; }
+	size_t TileCount() const { return flags.size(); }
+
+	// tile indices (tileY * TilesX() + tileX) in the order they were marked
+	const std::vector<uint32_t>& Marked() const { return marked; }
+
+private:
+	size_t tilesX = 0, tilesY = 0;
+	std::vector<uint8_t> flags;
+	std::vector<uint32_t> marked;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <AppConfig.h>
+
+// Ensemble run on the GPU: config.gpuBatchBoards boards of the configured size, board i seeded
+// with seed + i (so board 0 is the board of a single run with the same seed), are stepped
+// together with BoardBatchShader for config.benchmarkGenerations generations. The populations
+// of all boards are reduced on the GPU and read back asynchronously every generation there
+// is a free slot. Reports throughput, when boards died out and the final population spread.
+// Needs a GL context, so it opens an invisible window. Returns the process exit code.
+int RunGpuBatch(const AppConfig& config);
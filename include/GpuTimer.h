@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Metrics.h>
+
+// GPU-side pass timing with GL_TIME_ELAPSED queries. Each pass owns a small ring of queries
+// that are only read once GL reports them available, so timing never stalls the pipeline;
+// if a pass laps its ring the sample is dropped instead. Results go into the same Metrics
+// stream as the CPU timings, as "gpu <pass>", together with "gpu queue": how long the GPU
+// took to start a pass after the CPU submitted it. A large queue time with short passes
+// means the CPU/driver is ahead and the GPU is the bottleneck; the reverse means the driver is.
+class GpuTimer
+{
+public:
+	explicit GpuTimer(Metrics& metrics);
+
+	~GpuTimer();
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	// false if the context has no usable timer queries; Begin/End/Collect are then no-ops
+	bool Enabled() const { return enabled; }
+
+	size_t AddPass(const std::string& name);
+
+	// passes must not overlap: GL allows only one GL_TIME_ELAPSED query at a time
+	void Begin(size_t pass);
+	void End(size_t pass);
+
+	// records every finished query into the metrics without waiting on the GPU
+	void Collect();
+
+	uint64_t Dropped() const { return dropped; }
+
+private:
+	static const size_t QUERY_SLOTS = 4;
+
+	struct Query {
+		GLuint elapsed = 0;
+		GLuint finished = 0;
+		// GPU clock when the CPU issued the pass
+		GLint64 submitted = 0;
+		bool pending = false;
+	};
+
+	struct Pass {
+		size_t metric = 0;
+		std::array<Query, QUERY_SLOTS> queries;
+		size_t head = 0, tail = 0;
+		bool active = false;
+	};
+
+	Metrics& metrics;
+	size_t queueMetric = 0;
+	bool enabled = false;
+	uint64_t dropped = 0;
+	std::vector<Pass> passes;
+};
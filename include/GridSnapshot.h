@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <BitGrid.h>
+
+// Immutable copy of one generation. Shared between consumers (checkpointing, history, ...)
+// through std::shared_ptr<const GridSnapshot> so nobody has to copy the board again.
+struct GridSnapshot
+{
+	uint64_t generation = 0;
+	BitGrid grid;
+	// the board was edited at this generation, so it replaces whatever a consumer already
+	// has for it and the generations after it no longer follow from the earlier ones
+	bool edited = false;
+};
+
+using GridSnapshotPtr = std::shared_ptr<const GridSnapshot>;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <GridSnapshot.h>
+
+struct HistoryStats
+{
+	uint64_t frames = 0;
+	uint64_t keyframes = 0;
+	uint64_t encodedBytes = 0;
+	uint64_t rawBytes = 0;       // what storing every frame packed would have cost
+	double encodeSeconds = 0.0;
+};
+
+// Records a run as periodic keyframes plus XOR-delta frames (see DeltaCodec).
+// Seeking decodes only from the nearest keyframe at or before the requested generation.
+// With a path every frame is appended to the file as it is encoded instead of being kept,
+// and the file is flushed at every keyframe, so a killed run stays readable up to there.
+class HistoryRecorder
+{
+public:
+	// in memory, e.g. to Load a recording and Seek in it
+	explicit HistoryRecorder(uint64_t keyframeInterval);
+
+	// streams the recording to path, replacing the file
+	HistoryRecorder(uint64_t keyframeInterval, const std::string& path);
+
+	// flushes and closes
+	~HistoryRecorder();
+
+	HistoryRecorder(const HistoryRecorder&) = delete;
+	HistoryRecorder& operator=(const HistoryRecorder&) = delete;
+
+	// frames must arrive in increasing generation order; gaps are allowed. An edited board
+	// repeats its generation, and Seek returns the later of the two frames
+	void Record(GridSnapshotPtr snapshot);
+
+	// decodes the latest frame at or before generation; false if there is none. This and the
+	// queries below only see frames held in memory, never the ones streamed to a file
+	bool Seek(uint64_t generation, GridSnapshot& snapshot) const;
+
+	bool Empty() const { return frames.empty(); }
+	uint64_t FirstGeneration() const { return frames.empty() ? 0 : frames.front().generation; }
+	uint64_t LastGeneration() const { return frames.empty() ? 0 : frames.back().generation; }
+
+	const HistoryStats& Stats() const { return stats; }
+	void PrintStats() const;
+
+	// replaces the frames in memory; a frame cut short at the end of the file is left out
+	bool Load(const std::string& path);
+
+private:
+	struct Frame {
+		uint64_t generation = 0;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t keyframe = 0;   // index of the keyframe this frame decodes from
+		uint32_t width = 0, height = 0;
+	};
+
+	uint64_t keyframeInterval = 0;
+	// index of the keyframe the next delta frame decodes from
+	uint64_t lastKeyframe = 0;
+
+	std::vector<Frame> frames;
+	std::vector<uint8_t> data;
+
+	// streaming: frames go to file and are not kept; once a write fails they are dropped
+	bool streaming = false;
+	std::FILE* file = nullptr;
+	std::string path;
+
+	// appends frame and its encoded bytes (all of data) to the file
+	void write(const Frame& frame, bool flush);
+
+	GridSnapshotPtr previous;
+	HistoryStats stats;
+};
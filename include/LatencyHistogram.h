@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// HDR-style log-linear histogram of nanosecond latencies. Values below 128 ns get exact
+// buckets; above that every power of two is split into 64 buckets, so any recorded value
+// is reported within ~1.6% over the whole 64-bit range. Recording is O(1) and allocation free.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void Record(uint64_t valueNs);
+	void Merge(const LatencyHistogram& other);
+	void Reset();
+
+	uint64_t Count() const { return count; }
+	uint64_t Min() const { return count ? min : 0; }
+	uint64_t Max() const { return max; }
+	double Mean() const { return count ? double(sum) / double(count) : 0.0; }
+
+	// value at the given percentile (0-100), e.g. 99.9 for p999
+	uint64_t Percentile(double percentile) const;
+
+private:
+	static const int SUB_BUCKET_BITS = 6;
+	static const uint64_t LINEAR_LIMIT = 2ull << SUB_BUCKET_BITS;
+
+	std::vector<uint64_t> buckets;
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t min = UINT64_MAX;
+	uint64_t max = 0;
+
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketMidpoint(size_t index);
+};
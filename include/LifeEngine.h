@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include <vector>
+
+#include <BoardGrowth.h>
+#include <BoardStats.h>
+#include <Boundary.h>
+#include <CycleDetector.h>
+#include <DirtyTiles.h>
+#include <GridSnapshot.h>
+#include <SpscQueue.h>
+#include <TripleBuffer.h>
+
+// a cell set or cleared with the mouse
+struct CellEdit
+{
+	uint32_t x = 0, y = 0;
+	bool alive = false;
+};
+
+// One generation as published by the engine. tileVersions holds, per DirtyTiles tile, the
+// sequence number of the last publish that changed it, so a reader that skipped publishes can
+// still tell exactly which tiles differ from the frame it saw last.
+struct EngineFrame
+{
+	uint64_t generation = 0;
+	BitGrid grid;
+	uint64_t sequence = 0;
+	std::vector<uint64_t> tileVersions;
+	uint64_t hash = 0;          // BoardHash of grid, carried along by the step; equal boards have equal hashes
+	uint64_t period = 0;        // period of the cycle the board settled into, 0 = none found (yet)
+	int64_t originX = 0;        // position of cell (0, 0) on the starting board, moved by BoardGrowth
+	int64_t originY = 0;
+};
+
+// Runs the CPU rule on its own thread so a slow step never costs a frame and vsync never
+// throttles the simulation. Finished generations are published through a triple buffer; the
+// render thread takes the latest one without blocking. Edits go the other way through an
+// SPSC queue and are applied to the next published board. Generations that wantsSnapshot
+// accepts are also copied out as shared snapshots for the checkpoint/history/rewind consumers.
+class LifeEngine
+{
+public:
+	// steps are paced by a SimulationScheduler with the given rate (0 = unlimited) and catch-up;
+	// wantsSnapshot is called on the simulation thread and must be thread-safe; edited is set
+	// for a generation republished with edits applied
+	LifeEngine(const BitGrid& initial, uint64_t generation, double generationsPerSecond, unsigned maxCatchUp,
+		std::function<bool(uint64_t generation, bool edited)> wantsSnapshot);
+
+	// stops the thread
+	~LifeEngine();
+
+	LifeEngine(const LifeEngine&) = delete;
+	LifeEngine& operator=(const LifeEngine&) = delete;
+
+	// called on the simulation thread after every publish, e.g. to wake the render loop; set before Start
+	void SetPublishCallback(std::function<void()> callback) { onPublish = std::move(callback); }
+
+	// look for repeating boards (see CycleDetector) and report the period in EngineFrame;
+	// stopWhenFound also stops stepping until the board is edited. Call before Start.
+	void DetectCycles(bool stopWhenFound) { detectCycles = true; stopOnCycle = stopWhenFound; }
+
+	// computes BoardStats as part of every step and hands them to callback on the simulation
+	// thread, for the starting generation and every generation after it (edits are not reported
+	// on their own; the next step's births and deaths count from the edited board). Call before Start.
+	void CollectStats(std::function<void(uint64_t, const BoardStats&)> callback) { onStats = std::move(callback); }
+
+	// see Boundary; Dead unless set. Call before Start.
+	void SetBoundary(Boundary boundary) { this->boundary = boundary; }
+
+	// grow (and maybe shrink) the board with the pattern, see BoardGrowth; only with a dead
+	// boundary. The board's size and origin in EngineFrame change with it. Call before Start.
+	void SetGrowth(const BoardGrowth& growth) { this->growth = growth; }
+
+	void Start();
+	void Stop();
+
+	void SetPaused(bool paused) { this->paused.store(paused, std::memory_order_relaxed); }
+
+	// generations per second, 0 = unlimited
+	void SetRate(double generationsPerSecond) { rate.store(generationsPerSecond, std::memory_order_relaxed); }
+
+	// runs one generation, also while paused
+	void RequestSingleStep() { singleSteps.fetch_add(1, std::memory_order_relaxed); }
+
+	// late generations the scheduler dropped instead of catching up
+	uint64_t SkippedSteps() const { return skippedSteps.load(std::memory_order_relaxed); }
+
+	// render thread ----------------------------------------------------------------------
+	// false if the edit queue is full
+	bool PushEdit(const CellEdit& edit) { return edits.TryPush(edit); }
+
+	// picks up the newest published generation; false if there is nothing new
+	bool TakeLatest() { return published.Update(); }
+	const EngineFrame& Latest() const { return published.ReadBuffer(); }
+
+	bool PopSnapshot(GridSnapshotPtr& snapshot) { return snapshots.TryPop(snapshot); }
+
+	uint64_t DroppedSnapshots() const { return droppedSnapshots.load(std::memory_order_relaxed); }
+
+	// any thread ------------------------------------------------------------------------
+	// BoardHash of the last published board, e.g. to deduplicate or cache boards without touching them
+	uint64_t LatestHash() const { return latestHash.load(std::memory_order_acquire); }
+
+private:
+	static const size_t EDIT_QUEUE_SIZE = 4096;
+	static const size_t SNAPSHOT_QUEUE_SIZE = 64;
+
+	TripleBuffer<EngineFrame> published;
+	SpscQueue<CellEdit> edits;
+	SpscQueue<GridSnapshotPtr> snapshots;
+	std::function<bool(uint64_t, bool)> wantsSnapshot;
+	std::function<void()> onPublish;
+	std::function<void(uint64_t, const BoardStats&)> onStats;
+	unsigned maxCatchUp = 0;
+	Boundary boundary = Boundary::Dead;
+	bool detectCycles = false;
+	bool stopOnCycle = false;
+
+	std::atomic<bool> running{ false };
+	std::atomic<bool> paused{ false };
+	std::atomic<double> rate{ 0.0 };
+	std::atomic<uint32_t> singleSteps{ 0 };
+	std::atomic<uint64_t> droppedSnapshots{ 0 };
+	std::atomic<uint64_t> skippedSteps{ 0 };
+	std::atomic<uint64_t> latestHash{ 0 };
+
+	std::thread thread;
+
+	// simulation thread only
+	BoardGrowth growth;
+	DirtyTiles changedTiles;
+	std::vector<uint64_t> tileVersions;
+	uint64_t sequence = 0;
+	CycleDetector cycles;
+
+	void simulationLoop();
+
+	// republishes the current generation with the queued edits applied
+	void applyEdits();
+
+	// after growth reallocated next.grid
+	void resized(EngineFrame& next);
+
+	// stamps the changed tiles into the write buffer and publishes it;
+	// offerSnapshot: also hand the generation to wantsSnapshot; edited: the generation was
+	// published before and is offered again with the edits applied
+	void publish(bool offerSnapshot, bool edited = false);
+};
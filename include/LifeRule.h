@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include <BitGrid.h>
+#include <BoardStats.h>
+#include <Boundary.h>
+#include <DirtyTiles.h>
+
+// CPU implementation of the stepping rule in simulation.frag (B3/S23).
+// Works 64 cells at a time with a bit-sliced neighbour count. The boundary matches the shader's
+// (by default the outermost ring of the board is forced dead) so CPU and GPU runs stay in lockstep.
+namespace LifeRule
+{
+	// the rule for 64 cells at once: c holds the cells, each other word the neighbour of every
+	// cell in that direction, already shifted into place
+	inline uint64_t NextWord(uint64_t nw, uint64_t n, uint64_t ne, uint64_t w, uint64_t c, uint64_t e, uint64_t sw, uint64_t s, uint64_t se) {
+		// add the eight neighbour bits column-wise into ones/twos/fours with full adders
+		const uint64_t s0 = nw ^ n ^ ne, c0 = (nw & n) | ((nw ^ n) & ne);
+		const uint64_t s1 = w ^ e ^ sw, c1 = (w & e) | ((w ^ e) & sw);
+		const uint64_t s2 = s ^ se, c2 = s & se;
+
+		const uint64_t ones = s0 ^ s1 ^ s2, carryOnes = (s0 & s1) | ((s0 ^ s1) & s2);
+		const uint64_t t2 = c0 ^ c1 ^ c2, fourA = (c0 & c1) | ((c0 ^ c1) & c2);
+		const uint64_t twos = t2 ^ carryOnes, fourB = t2 & carryOnes;
+		const uint64_t fours = fourA | fourB;
+
+		// 3 neighbours -> alive, 2 neighbours -> unchanged, anything else -> dead
+		return twos & ~fours & (ones | c);
+	}
+
+	void Step(const BitGrid& current, BitGrid& next, Boundary boundary = Boundary::Dead);
+
+	// same, and marks every tile in which next differs from current (changed is cleared first)
+	void Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, Boundary boundary = Boundary::Dead);
+
+	// same, and carries hash (the BoardHash of current) over to next from the words that changed
+	void Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, uint64_t& hash, Boundary boundary = Boundary::Dead);
+
+	// same, and fills stats for next (births and deaths against current) from the same pass
+	void Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, uint64_t& hash, BoardStats& stats,
+		Boundary boundary = Boundary::Dead);
+}
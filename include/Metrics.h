@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <LatencyHistogram.h>
+
+// Named latency histograms for the render loop. Each metric keeps an interval histogram,
+// printed and reset every reportInterval seconds, and a histogram for the whole run that
+// is printed at shutdown. Only touched from the render thread.
+class Metrics
+{
+public:
+	// reportInterval <= 0 disables the periodic report
+	explicit Metrics(double reportInterval);
+
+	// returns the id to record with; registering an existing name returns its id
+	size_t Register(const std::string& name);
+
+	void Record(size_t id, uint64_t valueNs);
+	void RecordSeconds(size_t id, double seconds) { Record(id, seconds > 0.0 ? uint64_t(seconds * 1e9) : 0); }
+
+	// prints and resets the interval histograms once the interval has elapsed
+	void MaybeReport(double now);
+
+	void PrintSummary() const;
+
+private:
+	struct Metric {
+		std::string name;
+		LatencyHistogram interval;
+		LatencyHistogram total;
+	};
+
+	double reportInterval = 0.0;
+	double lastReport = -1.0;
+	std::vector<Metric> metrics;
+
+	static void printLine(const std::string& name, const LatencyHistogram& histogram);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <BitGrid.h>
+
+// one object found by ObjectLabeler; the box is inclusive
+struct LabeledObject
+{
+	uint64_t population = 0;
+	uint32_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+};
+
+// Splits the live cells of a board into objects: two cells belong to the same object when a
+// chain of live cells leads from one to the other with no step longer than distance along
+// either axis (1 joins 8-connected cells; 2 also joins cells one empty cell apart, which keeps
+// pseudo-objects such as a still life leaning on another in one piece).
+// Works on horizontal runs of live cells rather than cells: runs are found with bit tricks on
+// the packed rows, then joined with union-find. Bands of rows are handled by separate threads,
+// and only the few rows where bands meet are joined afterwards.
+class ObjectLabeler
+{
+public:
+	// a horizontal run of live cells [start, end] in row y
+	struct Run {
+		uint32_t y = 0, start = 0, end = 0;
+		uint32_t object = 0;    // index into Objects()
+	};
+
+	// threads 0 uses one per hardware thread
+	explicit ObjectLabeler(unsigned distance = 1, unsigned threads = 0);
+
+	// objects are numbered in the order of their first cell, bottom row first
+	const std::vector<LabeledObject>& Label(const BitGrid& grid);
+
+	const std::vector<LabeledObject>& Objects() const { return objects; }
+
+	// every run of the last board in row-major order, with the object it belongs to
+	const std::vector<Run>& Runs() const { return runs; }
+
+private:
+	unsigned distance = 1;
+	unsigned threads = 0;
+
+	std::vector<Run> runs;
+	std::vector<uint32_t> rowStarts;    // first run of each row, plus one past the last
+	std::vector<uint32_t> parents;      // union-find forest over runs, a parent never follows its child
+	std::vector<LabeledObject> objects;
+
+	void findRuns(const BitGrid& grid, size_t firstRow, size_t lastRow);
+
+	// joins the runs of rows [firstRow, lastRow) with each other and with the rows up to
+	// distance below them, but not below floorRow
+	void joinRows(size_t firstRow, size_t lastRow, size_t floorRow);
+
+	uint32_t find(uint32_t run);
+	void join(uint32_t a, uint32_t b);
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BitGrid.h>
+
+// A small pattern cropped to its bounding box, one word per row from the bottom with bit x
+// for column x, so at most MAX_SIZE cells either way. Orientations are computed on the packed
+// rows: mirrors reverse the bits or the rows, and the transpose is the word-parallel
+// block-swap transpose, which flips a whole 64x64 bit matrix in 6 passes of shifts and masks.
+struct Pattern
+{
+	static const size_t MAX_SIZE = 64;
+
+	uint32_t width = 0, height = 0;
+	std::vector<uint64_t> rows;
+
+	// false when the live cells of grid span more than MAX_SIZE
+	static bool FromGrid(const BitGrid& grid, Pattern& pattern);
+
+	// the live cells of count one-word rows stride words apart, such as a SmallBoard lane
+	static void FromRows(const uint64_t* rows, size_t count, size_t stride, Pattern& pattern);
+
+	// bit 0 transposes, bit 1 mirrors x, bit 2 mirrors y
+	Pattern Oriented(int orientation) const;
+
+	// the smallest of the 8 orientations, so every orientation of an object gives the same one
+	Pattern Canonical() const;
+
+	// 64-bit content hash; equal for equal patterns, so the hash of Canonical() identifies an
+	// object in any orientation
+	uint64_t Hash() const;
+
+	// "<width>x<height>_<rows in hex, bottom first>"
+	std::string Code() const;
+
+	bool operator==(const Pattern& other) const;
+	bool operator<(const Pattern& other) const;
+};
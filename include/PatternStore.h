@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+#include <Pattern.h>
+
+// Content-addressed set of patterns: every pattern is kept once in canonical form, under the
+// hash of that form, so any orientation of an object finds the same entry in O(1).
+// With a path the store is also kept on disk as one append-only file: an 8-byte magic, then
+// per pattern its hash as uint64, its width and height as uint32 and its rows as uint64, all
+// little-endian. Opening reads the whole file into memory; new patterns are appended as they
+// are added.
+class PatternStore
+{
+public:
+	// in memory only
+	PatternStore() = default;
+
+	// loads path if it exists and appends new patterns to it
+	explicit PatternStore(const std::string& path);
+
+	// flushes and closes
+	~PatternStore();
+
+	PatternStore(const PatternStore&) = delete;
+	PatternStore& operator=(const PatternStore&) = delete;
+
+	// adds the canonical form of pattern unless it is known; returns the key it is stored under
+	uint64_t Add(const Pattern& pattern);
+
+	// as Add, for a pattern that is already canonical
+	uint64_t AddCanonical(const Pattern& canonical);
+
+	// nullptr when key was never added
+	const Pattern* Find(uint64_t key) const;
+
+	const std::unordered_map<uint64_t, Pattern>& Patterns() const { return patterns; }
+
+	size_t Size() const { return patterns.size(); }
+
+	// patterns added since the store was opened
+	size_t Added() const { return added; }
+
+private:
+	std::unordered_map<uint64_t, Pattern> patterns;
+	std::FILE* file = nullptr;
+	size_t added = 0;
+
+	bool load(const std::string& path);
+};
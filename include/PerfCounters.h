@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Hardware performance counters for the calling thread via perf_event_open (Linux only).
+// Each counter is opened on its own, so a container or VM that exposes only some events
+// still reports those; anything unavailable is simply marked as such.
+class PerfCounters
+{
+public:
+	enum Counter { Cycles, Instructions, LlcMisses, BranchMisses, CounterCount };
+
+	PerfCounters();
+
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool AnyAvailable() const;
+	bool Available(Counter counter) const { return fds[counter] >= 0; }
+
+	// why counters could not be opened, empty if all of them were
+	const std::string& UnavailableReason() const { return reason; }
+
+	void Start();
+	void Stop();
+
+	// scaled for multiplexing; false if the counter is unavailable
+	bool Read(Counter counter, uint64_t& value) const;
+
+	static const char* Name(Counter counter);
+
+private:
+	std::array<int, CounterCount> fds;
+	std::string reason;
+};
@@ -6,6 +6,8 @@
 #include <random>
 #include <vector>
 
+#include <BitGrid.h>
+
 class RandomGenerator
 {
 private:
@@ -16,10 +18,37 @@ private:
 public:
 	RandomGenerator() : gen(rd() ^ std::chrono::steady_clock::now().time_since_epoch().count()) {}
 
+	// deterministic sequence for reproducible runs
+	explicit RandomGenerator(uint64_t seed) : gen(seed) {}
+
 	void fillGridWithNoise(std::vector<float>& grid) {
 		std::generate(grid.begin(), grid.end(), [this]() {return distrib(gen); });
 	}
 
+	// every cell alive with probability 1/2, 64 cells per draw
+	void fillGridWithNoise(BitGrid& grid) {
+		const uint64_t lastMask = grid.LastWordMask();
+		for (size_t y = 0; y < grid.Height(); y++) {
+			uint64_t* row = grid.Row(y);
+			for (size_t i = 0; i < grid.WordsPerRow(); i++) {
+				row[i] = gen();
+			}
+			row[grid.WordsPerRow() - 1] &= lastMask;
+		}
+	}
+
+	// every cell of the rectangle alive with probability 1/2, the rest of the grid untouched
+	void fillRectWithNoise(BitGrid& grid, size_t left, size_t bottom, size_t width, size_t height) {
+		for (size_t y = bottom; y < bottom + height; y++) {
+			for (size_t x = left; x < left + width; x += 64) {
+				const uint64_t bits = gen();
+				for (size_t i = 0; i < 64 && x + i < left + width; i++) {
+					grid.Set(x + i, y, (bits >> i) & 1);
+				}
+			}
+		}
+	}
+
 	void diagnosticPrintout(const std::vector<float>& grid, int width) {
 		std::cout << "Checking for pattern repetition:\n";
 		for (size_t i = 0; i < grid.size(); ++i) {
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Boundary.h>
+#include <GridSnapshot.h>
+
+// Bounded history of recent generations for scrubbing backwards in the viewer.
+// Every interval-th generation is stored as an XOR delta against the previous stored one,
+// on top of a full base board for the oldest entry. Generations in between are rebuilt on a
+// worker thread by re-simulating from the nearest stored one; the rebuilt segment is cached so
+// stepping back and forth inside it is immediate.
+class RewindBuffer
+{
+public:
+	// boundary must be the one the stored generations were stepped with
+	RewindBuffer(uint64_t interval, size_t maxBytes, Boundary boundary);
+
+	~RewindBuffer();
+
+	bool Enabled() const { return maxBytes > 0; }
+	bool IsDue(uint64_t generation) const { return Enabled() && generation % interval == 0; }
+
+	// generations must arrive in increasing order; an edited snapshot starts over from itself
+	void Store(GridSnapshotPtr snapshot);
+
+	// oldest generation that can still be reconstructed
+	uint64_t OldestGeneration() const;
+
+	// asks the worker for a generation; newer requests replace pending ones
+	void Request(uint64_t generation);
+
+	// returns the most recent finished reconstruction, if one arrived since the last call
+	bool TakeResult(GridSnapshot& snapshot);
+
+private:
+	struct Entry {
+		uint64_t generation = 0;
+		std::vector<uint8_t> delta;   // XOR against the previous entry, empty for the base
+	};
+
+	uint64_t interval = 1;
+	size_t maxBytes = 0;
+	Boundary boundary = Boundary::Dead;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+
+	BitGrid base;                     // full board of entries.front()
+	std::deque<Entry> entries;
+	size_t storedBytes = 0;
+	GridSnapshotPtr newest;           // full board of entries.back(), to diff the next one against
+	uint64_t restarts = 0;            // lets the worker drop a segment rebuilt before a restart
+
+	bool hasRequest = false;
+	uint64_t requestedGeneration = 0;
+
+	bool hasResult = false;
+	GridSnapshot result;
+
+	std::thread worker;
+
+	void workerLoop();
+
+	// decodes the stored entry at or before generation; caller holds the lock
+	bool decodeEntry(uint64_t generation, GridSnapshot& snapshot) const;
+};
@@ -13,6 +13,8 @@ public:
     // Constructors
     Shader();
     Shader(const char* vertexPath, const char* fragmentPath);
+    // defines (e.g. "#define FOO\n") are inserted after the fragment shader's #version line
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines);
 
     ~Shader() = default;
 
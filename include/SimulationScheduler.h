@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Decides when generations are due, independent of how fast frames are drawn.
+// Steps are scheduled on a fixed timeline of 1 / rate seconds. When the caller falls behind,
+// up to maxCatchUp extra steps are run on the next call and anything beyond that is dropped
+// (maxCatchUp = 0 drops every late step), so a stall never turns into an unbounded burst.
+// Rate 0 is unlimited: every call runs one step. Times are in seconds on any monotonic clock.
+// Not thread-safe; owned by whichever thread does the stepping.
+class SimulationScheduler
+{
+public:
+	SimulationScheduler(double generationsPerSecond, unsigned maxCatchUp);
+
+	void SetRate(double generationsPerSecond, double now);
+	double Rate() const { return rate; }
+
+	void SetPaused(bool paused, double now);
+	bool Paused() const { return paused; }
+
+	// runs exactly one generation on the next call, also while paused
+	void RequestSingleStep() { singleStepPending = true; }
+
+	// generations to run now; advances the timeline
+	unsigned StepsDue(double now);
+
+	// how long the caller may sleep before the next step is due; 0 if one is due already,
+	// a negative value if nothing will become due on its own (paused)
+	double TimeUntilNextStep(double now) const;
+
+	// late generations that were dropped instead of caught up
+	uint64_t SkippedSteps() const { return skipped; }
+
+private:
+	double rate = 0.0;
+	double period = 0.0;
+	unsigned maxCatchUp = 0;
+	bool paused = false;
+	bool singleStepPending = false;
+	bool started = false;
+	double nextStep = 0.0;
+	uint64_t skipped = 0;
+};
@@ -4,38 +4,145 @@
 #include <GLFW/glfw3.h>
 
 #include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
 #include <vector>
 
+#include <BitGrid.h>
+#include <BoardStats.h>
+#include <Boundary.h>
 #include <Shader.h>
 
+// Steps the board in a fragment shader. The board is split into tiles of at most tileSize
+// cells a side so it is not limited by GL_MAX_TEXTURE_SIZE. Every tile owns two textures
+// (ping-pong) with a one cell halo around it; before each generation the halos are filled
+// with the neighbouring tiles' edge cells, then every tile steps independently.
+// The boundary is handled by the same exchange: halos on the board's edges are filled from
+// wherever the boundary says the cells beyond the edge come from (the opposite edge for a torus,
+// mirrored for the Klein bottle, the edge itself for a mirror), or stay dead with a dead ring.
+// Optionally every tile also keeps an age plane: how many generations each live cell has
+// survived, saturating at 255. It is a separate R8 texture written as a second render target
+// of the same pass, so the plain step reads and writes nothing extra when it is off.
 class SimulationShader : public Shader
 {
 
 public:
-	SimulationShader(const char* vertexPath, const char* fragmentPath);
+	// tiles used when the board does not fit in one texture
+	static const size_t AUTO_TILE_SIZE = 4096;
+
+	SimulationShader(const char* vertexPath, const char* fragmentPath, bool trackAge = false, Boundary boundary = Boundary::Dead);
 
 	~SimulationShader();
 
-	void Initialize(size_t simWidth, size_t simHeight);
+	// tileSize 0 uses a single tile when the board fits in one texture, AUTO_TILE_SIZE otherwise;
+	// with several tiles the size must be a multiple of 64 so readbacks stay word aligned
+	void Initialize(size_t simWidth, size_t simHeight, size_t tileSize = 0);
 
-	void ProvideInitialGrid(std::vector<float>& grid);
+	void ProvideInitialGrid(const BitGrid& grid);
 	
 	void RunSimulation();
 
-	void CopySimulationResultsToTexture(GLuint& targetTexture);
+	// draws the tiles that intersect the view with renderShader, which samples the tile on
+	// texture unit 0 (and its ages on unit 3) at cell - tileOrigin + 1; zoomedOut refreshes
+	// their mipmaps first
+	void Draw(const Shader& renderShader, const glm::vec2& viewOrigin, const glm::vec2& viewSize,
+		const glm::ivec2& framebufferSize, bool zoomedOut);
+
+	// overwrites a single cell of the current state, e.g. for mouse edits
+	void SetCell(size_t x, size_t y, bool alive);
 
 	void DebugSimulationTexture();
 
+	// Asynchronous state readback: packs the current state to 1 bit per cell on the GPU and
+	// starts a transfer into a pixel buffer. Returns false if every readback slot is busy.
+	// edited is handed back with the result, for a generation read again after SetCell
+	bool RequestStateReadback(uint64_t generation, bool edited = false);
+
+	// Completes the oldest pending readback if the GPU has finished it; never stalls unless
+	// wait is set, which blocks until the GPU has finished it.
+	bool PollStateReadback(uint64_t& generation, bool& edited, BitGrid& grid, bool wait = false);
+
+	bool HasPendingReadbacks() const { return readbackCount > 0; }
+
+	// Asynchronous BoardStats of the current generation: a reduction pass sums blocks of
+	// STATS_BLOCK x STATS_BLOCK cells on the GPU and only the block sums are read back.
+	// Call right after RunSimulation, since births and deaths compare against the tiles'
+	// previous textures. Returns false if every stats slot is busy. The resources are
+	// created on first use. This is a pass of its own rather than another render target of
+	// simulation.frag: that shader writes one cell per fragment, so the target would still
+	// need this reduction, and every step would pay for it even with no stats requested.
+	bool RequestStats(uint64_t generation);
+
+	// completes the oldest pending stats request; wait blocks until the GPU has finished it
+	bool PollStats(uint64_t& generation, BoardStats& stats, bool wait = false);
+
+	bool HasPendingStats() const { return statsCount > 0; }
+
+	bool TracksAge() const { return trackAge; }
+
 private:
+	static const size_t READBACK_SLOTS = 3;
+	// stats requests come every generation, so more of them can be in flight
+	static const size_t STATS_SLOTS = 8;
+	// must match stats.frag
+	static const size_t STATS_BLOCK = 32;
+
+	struct Readback {
+		GLuint PBO = 0;
+		GLsync fence = nullptr;
+		uint64_t generation = 0;
+		bool edited = false;
+	};
+
+	struct Tile {
+		glm::ivec2 origin = glm::ivec2(0);    // first interior cell on the board
+		glm::ivec2 size = glm::ivec2(0);      // interior cells, the textures are two larger
+		GLuint textures[2] = { 0, 0 };
+		GLuint FBOs[2] = { 0, 0 };
+		GLuint ages[2] = { 0, 0 };          // only with trackAge
+	};
+
 	GLuint VAO, VBO, EBO;
-	GLuint FBO;
-	GLuint texture;
+
+	bool trackAge = false;
+	Boundary boundary = Boundary::Dead;
+	std::vector<Tile> tiles;
+	size_t tilesX = 0, tilesY = 0, tileSize = 0;
+	// index of the textures holding the current generation, the same for every tile
+	size_t current = 0;
+	// draw target for halo copies that have to be mirrored, which only a blit can do
+	GLuint haloFBO = 0;
+
+	Shader packShader;
+	GLuint packFBO = 0;
+	GLuint packTexture = 0;
+	size_t packWidth = 0;
+
+	std::array<Readback, READBACK_SLOTS> readbacks;
+	size_t readbackHead = 0, readbackCount = 0;
+
+	Shader statsShader;
+	GLuint statsFBO = 0;
+	GLuint statsTextures[2] = { 0, 0 };   // counts and bounds, one texel per block of the largest tile
+	size_t statsBlocks = 0;               // blocks over all tiles
+	std::array<Readback, STATS_SLOTS> statsSlots;
+	size_t statsHead = 0, statsCount = 0;
 
 	size_t simWidth = 0, simHeight = 0;
 
 	void createSimulationQuad();
 
-	void createTexture();
+	void createTiles();
 
-};
+	void exchangeHalos();
 
+	// copies the board cells [x, x + width) x [y, y + height) into the tile texture bound to
+	// GL_TEXTURE_2D (and, for mirrored copies, to haloFBO) at (targetX, targetY), from whichever
+	// tiles hold them; mirrored reverses x
+	void copyHaloCells(GLint targetX, GLint targetY, size_t x, size_t y, size_t width, size_t height, bool mirrored);
+
+	void createReadbackResources();
+
+	void createStatsResources();
+
+};
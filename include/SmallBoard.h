@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include <LifeRule.h>
+
+// Boards of at most 64 columns, one word per row, in a fixed std::array: for running huge
+// numbers of tiny boards (soup objects in isolation, parameter sweeps) without any of the
+// allocation, padding and edge handling of BitGrid. The size is a template parameter, so the
+// boundary (the outermost ring forced dead, as in LifeRule) is a set of constant masks.
+//
+// SmallBoardBatch steps Lanes boards together. Their words are interleaved, row y of every
+// board next to each other, so the inner loop runs the same bit operations over Lanes
+// independent words and the compiler turns it into SIMD over the lanes.
+template <size_t Width, size_t Height, size_t Lanes>
+class SmallBoardBatch
+{
+	static_assert(Width >= 3 && Width <= 64 && Height >= 3, "a small board is 3 to 64 cells wide and at least 3 high");
+
+public:
+	static const size_t WIDTH = Width, HEIGHT = Height, LANES = Lanes;
+
+	void Clear() { words.fill(0); }
+
+	uint64_t& Row(size_t lane, size_t y) { return words[y * Lanes + lane]; }
+	uint64_t Row(size_t lane, size_t y) const { return words[y * Lanes + lane]; }
+
+	// the first row of lane; row y follows at index y * Lanes
+	const uint64_t* Lane(size_t lane) const { return &words[lane]; }
+
+	bool Get(size_t lane, size_t x, size_t y) const { return (Row(lane, y) >> x) & 1; }
+
+	void Set(size_t lane, size_t x, size_t y, bool alive) {
+		Row(lane, y) = alive ? Row(lane, y) | (1ull << x) : Row(lane, y) & ~(1ull << x);
+	}
+
+	void ClearLane(size_t lane) {
+		for (size_t y = 0; y < Height; y++) {
+			Row(lane, y) = 0;
+		}
+	}
+
+	uint64_t Population(size_t lane) const {
+		uint64_t population = 0;
+		for (size_t y = 0; y < Height; y++) {
+			population += uint64_t(std::popcount(Row(lane, y)));
+		}
+		return population;
+	}
+
+	// whether every live cell of lane is at least margin cells away from the edge
+	bool Within(size_t lane, size_t margin) const {
+		const uint64_t inside = (~0ull >> (64 - Width + 2 * margin)) << margin;
+		uint64_t columns = 0;
+		for (size_t y = 0; y < Height; y++) {
+			const uint64_t row = Row(lane, y);
+			if ((y < margin || y >= Height - margin) && row != 0) {
+				return false;
+			}
+			columns |= row;
+		}
+		return (columns & ~inside) == 0;
+	}
+
+	void CopyLane(size_t lane, const SmallBoardBatch& from, size_t fromLane) {
+		for (size_t y = 0; y < Height; y++) {
+			Row(lane, y) = from.Row(fromLane, y);
+		}
+	}
+
+	// whether lane holds the same board as lane otherLane of other
+	bool SameBoard(size_t lane, const SmallBoardBatch& other, size_t otherLane) const {
+		for (size_t y = 0; y < Height; y++) {
+			if (Row(lane, y) != other.Row(otherLane, y)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// steps every lane one generation into next
+	void Step(SmallBoardBatch& next) const {
+		for (size_t lane = 0; lane < Lanes; lane++) {
+			next.words[lane] = 0;
+			next.words[(Height - 1) * Lanes + lane] = 0;
+		}
+		for (size_t y = 1; y + 1 < Height; y++) {
+			const uint64_t* above = &this->words[(y - 1) * Lanes];
+			const uint64_t* row = &this->words[y * Lanes];
+			const uint64_t* below = &this->words[(y + 1) * Lanes];
+			uint64_t* out = &next.words[y * Lanes];
+			for (size_t lane = 0; lane < Lanes; lane++) {
+				// a row is one word, so the neighbours outside it are the zero bits shifted in
+				out[lane] = INTERIOR & LifeRule::NextWord(above[lane] << 1, above[lane], above[lane] >> 1,
+					row[lane] << 1, row[lane], row[lane] >> 1, below[lane] << 1, below[lane], below[lane] >> 1);
+			}
+		}
+	}
+
+private:
+	// the columns between the dead left and right edge
+	static constexpr uint64_t INTERIOR = (~0ull >> (64 - Width)) & ~1ull & ~(1ull << (Width - 1));
+
+	std::array<uint64_t, Height * Lanes> words{};
+};
+
+// a single small board
+template <size_t Width, size_t Height>
+using SmallBoard = SmallBoardBatch<Width, Height, 1>;
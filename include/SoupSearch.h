@@ -0,0 +1,11 @@
+#pragma once
+
+#include <AppConfig.h>
+
+// Headless census of random soups: config.soupCount soups of 16 x 16 random cells,
+// each seeded from its index in a sequence fixed by config.seed, are run on worker threads until
+// they settle into a cycle. What is left is split into objects, each classified by period and
+// shape (the same in any orientation and phase), and the counts of all soups are added up.
+// Objects that drift towards the edge of the board are removed as escapees on the way.
+// Returns the process exit code.
+int RunSoupSearch(const AppConfig& config);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Capacity is rounded up to a power of two; TryPush fails instead of blocking when full.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// producer thread only
+	bool TryPush(T value) {
+		const size_t tail = this->tail.load(std::memory_order_relaxed);
+		if (tail - head.load(std::memory_order_acquire) == slots.size()) {
+			return false;
+		}
+		slots[tail & mask] = std::move(value);
+		this->tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer thread only
+	bool TryPop(T& value) {
+		const size_t head = this->head.load(std::memory_order_relaxed);
+		if (head == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		value = std::move(slots[head & mask]);
+		// release the slot's resources on the consumer side, not when it is next overwritten
+		slots[head & mask] = T();
+		this->head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::vector<T> slots;
+	size_t mask = 0;
+	// on separate cache lines so producer and consumer do not false-share
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) std::atomic<size_t> tail{ 0 };
+};
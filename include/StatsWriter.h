@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <BoardStats.h>
+
+// Streams one BoardStats record per generation to a file. Paths ending in .csv get a CSV
+// with a header line; anything else gets the binary format: an 8-byte magic followed by
+// fixed 48-byte little-endian records (generation, population, births, deaths as uint64,
+// then minX, minY, maxX, maxY as uint32). Writes are buffered, so a record costs no system
+// call; use it from one thread only.
+class StatsWriter
+{
+public:
+	explicit StatsWriter(const std::string& path);
+
+	// flushes and closes
+	~StatsWriter();
+
+	StatsWriter(const StatsWriter&) = delete;
+	StatsWriter& operator=(const StatsWriter&) = delete;
+
+	bool IsOpen() const { return file != nullptr; }
+
+	void Write(uint64_t generation, const BoardStats& stats);
+
+	uint64_t Records() const { return records; }
+
+private:
+	std::FILE* file = nullptr;
+	bool csv = false;
+	uint64_t records = 0;
+};
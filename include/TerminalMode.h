@@ -0,0 +1,8 @@
+#pragma once
+
+#include <AppConfig.h>
+
+// Headless run for terminals without a display (e.g. over SSH): the CPU engine steps the
+// board on its own thread and the latest generation is drawn as braille at
+// config.terminalFps until Ctrl+C. Returns the process exit code.
+int RunTerminal(const AppConfig& config);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BitGrid.h>
+
+// Draws a board into the terminal with Unicode braille: every glyph holds 2x4 dots. Boards
+// larger than the terminal are scaled down by whole cells, and a dot is lit when at least
+// 1/16 of the cells in its block are alive (one cell while blocks are small), so busy areas
+// do not all turn solid. Only glyphs that changed since the last frame are sent, each run
+// behind one cursor-addressing escape, and a frame goes out in a single write.
+class TerminalRenderer
+{
+public:
+	// switches to the alternate screen and hides the cursor
+	TerminalRenderer();
+
+	// restores the screen and cursor
+	~TerminalRenderer();
+
+	TerminalRenderer(const TerminalRenderer&) = delete;
+	TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+	// status is shown on the bottom line
+	void Draw(const BitGrid& grid, const std::string& status);
+
+	uint64_t Frames() const { return frames; }
+	uint64_t BytesWritten() const { return bytesWritten; }
+
+private:
+	// unchanged glyphs between two changes that are resent rather than paying for another
+	// cursor escape (about 8 bytes against at most 3 per glyph)
+	static const size_t MAX_GAP = 2;
+
+	size_t columns = 0, rows = 0;       // terminal size in characters
+	std::vector<uint8_t> shown;         // braille dot patterns on screen, row-major from the top
+	std::vector<uint8_t> glyphs;        // the frame being drawn
+	std::vector<uint32_t> dotCounts;    // live cells behind each dot of the current dot row
+	std::string shownStatus;
+	std::string frame;
+
+	uint64_t frames = 0;
+	uint64_t bytesWritten = 0;
+
+	// true when the size changed since the last call
+	bool querySize();
+	void rasterize(const BitGrid& grid);
+	void appendGlyph(uint8_t dots);
+	void appendCursor(size_t row, size_t column);
+	void writeFrame();
+};
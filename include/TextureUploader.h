@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <LifeEngine.h>
+
+struct UploadStats
+{
+	uint64_t uploads = 0;
+	uint64_t fullUploads = 0;
+	uint64_t tilesUploaded = 0;
+	uint64_t bytesUploaded = 0;
+	uint64_t unbufferedUploads = 0;   // every pixel buffer was still in use by the GPU
+};
+
+// Streams boards from the CPU engine into a bit-packed GL_R32UI display texture: 32 cells per
+// texel, laid out exactly like BitGrid rows (two texels per word), so the words are uploaded as
+// they are and shader.frag extracts each cell's bit. Only the tiles that changed since the last
+// upload are sent, copied into a ring of pixel unpack buffers (mapped unsynchronized, guarded
+// by fences) and uploaded with one glTexSubImage2D per horizontal run of tiles. When more than
+// fullUploadFraction of the tiles changed, a single full upload is cheaper than the many small ones.
+class TextureUploader
+{
+public:
+	explicit TextureUploader(double fullUploadFraction);
+
+	~TextureUploader();
+
+	TextureUploader(const TextureUploader&) = delete;
+	TextureUploader& operator=(const TextureUploader&) = delete;
+
+	void Upload(const EngineFrame& frame, GLuint texture);
+
+	// uploads a board that is not part of the engine's sequence (e.g. a rewound generation)
+	void UploadGrid(const BitGrid& grid, GLuint texture);
+
+	const UploadStats& Stats() const { return stats; }
+	void PrintStats() const;
+
+private:
+	static const size_t SLOTS = 3;
+	static const size_t TILE_SIZE = DirtyTiles::TILE_SIZE;
+
+	struct Slot {
+		GLuint PBO = 0;
+		GLsync fence = nullptr;
+	};
+
+	// one glTexSubImage2D call; x and width in texels
+	struct Region {
+		size_t x = 0, y = 0, width = 0, height = 0;
+		size_t offset = 0;
+	};
+
+	static const size_t CELLS_PER_TEXEL = 32;
+
+	double fullUploadFraction = 0.25;
+	std::array<Slot, SLOTS> slots;
+	size_t nextSlot = 0;
+	size_t slotBytes = 0;
+
+	bool valid = false;
+	GLuint uploadedTexture = 0;
+	size_t uploadedWidth = 0, uploadedHeight = 0;
+	uint64_t uploadedSequence = 0;
+
+	std::vector<uint32_t> dirtyTiles;
+	std::vector<Region> regions;
+	UploadStats stats;
+
+	void uploadFull(const BitGrid& grid, GLuint texture);
+	void uploadTiles(const BitGrid& grid, size_t tilesX, GLuint texture);
+	void createBuffers(size_t bytes);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped timing zones recorded into per-thread lock-free ring buffers and exported as
+// Chrome trace-event JSON (load it in chrome://tracing or ui.perfetto.dev).
+// Build with GOL_ENABLE_TRACING=0 to compile the zones out; when compiled in but disabled
+// a zone costs one relaxed atomic load.
+#ifndef GOL_ENABLE_TRACING
+#define GOL_ENABLE_TRACING 1
+#endif
+
+namespace Trace
+{
+	extern std::atomic<bool> enabled;
+
+	inline bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+	void SetEnabled(bool value);
+
+	uint64_t NowNanoseconds();
+
+	// name must outlive the trace (string literals)
+	void Record(const char* name, uint64_t startNs, uint64_t endNs);
+
+	void SetThreadName(const char* name);
+
+	// writes every buffered event; safe to call while other threads keep recording
+	bool WriteChromeJson(const std::string& path);
+
+	class Zone
+	{
+	public:
+		explicit Zone(const char* name) : name(name), startNs(Enabled() ? NowNanoseconds() : 0) {}
+
+		~Zone() {
+			if (startNs != 0) {
+				Record(name, startNs, NowNanoseconds());
+			}
+		}
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	private:
+		const char* name;
+		uint64_t startNs;
+	};
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if GOL_ENABLE_TRACING
+#define TRACE_ZONE(name) Trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#endif
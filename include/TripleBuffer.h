@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer triple buffer. The writer fills WriteBuffer()
+// and publishes it; the reader picks up the most recent published buffer with Update().
+// Neither side ever waits: the writer always has a free buffer, and generations the reader
+// did not get to in time are simply overwritten.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+
+	explicit TripleBuffer(const T& initial) { buffers.fill(initial); }
+
+	// writer side ------------------------------------------------------------------------
+	T& WriteBuffer() { return buffers[writeIndex]; }
+
+	// the buffer published last; stays untouched until the writer gets it back through a
+	// later Publish, so the writer may keep reading it (e.g. as the source for the next step)
+	const T& LastPublished() const { return buffers[publishedIndex]; }
+
+	void Publish() {
+		publishedIndex = writeIndex;
+		writeIndex = state.exchange(uint8_t(writeIndex | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// reader side ------------------------------------------------------------------------
+	// swaps in the latest published buffer; false if nothing was published since last time
+	bool Update() {
+		if (!(state.load(std::memory_order_relaxed) & FRESH)) {
+			return false;
+		}
+		readIndex = state.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	const T& ReadBuffer() const { return buffers[readIndex]; }
+
+private:
+	static const uint8_t INDEX_MASK = 3;
+	static const uint8_t FRESH = 4;
+
+	std::array<T, 3> buffers;
+	// index of the buffer between writer and reader, plus FRESH if the reader has not seen it
+	std::atomic<uint8_t> state{ 1 };
+	uint8_t writeIndex = 0;
+	uint8_t publishedIndex = 1;
+	uint8_t readIndex = 2;
+};
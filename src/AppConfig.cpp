@@ -0,0 +1,280 @@
+#include "AppConfig.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    std::string requireValue(int argc, char** argv, int& i) {
+        if (i + 1 >= argc) {
+            throw std::runtime_error("FAILURE::MISSING_ARGUMENT_VALUE(" + std::string(argv[i]) + ")");
+        }
+        return argv[++i];
+    }
+
+    uint64_t parseUnsigned(const std::string& flag, const std::string& value) {
+        try {
+            size_t used = 0;
+            const unsigned long long parsed = std::stoull(value, &used);
+            if (used != value.size() || value[0] == '-') {
+                throw std::invalid_argument(value);
+            }
+            return parsed;
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + flag + " " + value + ")");
+        }
+    }
+
+    void parseSize(const std::string& flag, const std::string& value, unsigned int& width, unsigned int& height) {
+        const size_t separator = value.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + flag + " " + value + ")");
+        }
+        const uint64_t w = parseUnsigned(flag, value.substr(0, separator));
+        const uint64_t h = parseUnsigned(flag, value.substr(separator + 1));
+        if (w < MIN_BOARD_SIZE || h < MIN_BOARD_SIZE || w > MAX_BOARD_SIZE || h > MAX_BOARD_SIZE) {
+            throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + flag + " " + value + ")");
+        }
+        width = unsigned(w);
+        height = unsigned(h);
+    }
+
+    double parseDouble(const std::string& flag, const std::string& value) {
+        try {
+            size_t used = 0;
+            const double parsed = std::stod(value, &used);
+            if (used != value.size() || parsed < 0.0) {
+                throw std::invalid_argument(value);
+            }
+            return parsed;
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + flag + " " + value + ")");
+        }
+    }
+}
+
+AppConfig ParseCommandLine(int argc, char** argv) {
+    AppConfig config;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.showHelp = true;
+        }
+        else if (arg == "--engine") {
+            const std::string value = requireValue(argc, argv, i);
+            if (value == "gpu") {
+                config.engine = SimulationEngine::Gpu;
+            }
+            else if (value == "cpu") {
+                config.engine = SimulationEngine::Cpu;
+            }
+            else {
+                throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + arg + " " + value + ")");
+            }
+        }
+        else if (arg == "--boundary") {
+            const std::string value = requireValue(argc, argv, i);
+            if (value == "dead") {
+                config.boundary = Boundary::Dead;
+            }
+            else if (value == "torus") {
+                config.boundary = Boundary::Torus;
+            }
+            else if (value == "klein") {
+                config.boundary = Boundary::Klein;
+            }
+            else if (value == "mirror") {
+                config.boundary = Boundary::Mirror;
+            }
+            else {
+                throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + arg + " " + value + ")");
+            }
+        }
+        else if (arg == "--grow") {
+            config.growBoard = true;
+        }
+        else if (arg == "--shrink") {
+            config.growBoard = true;
+            config.shrinkBoard = true;
+        }
+        else if (arg == "--on-cycle") {
+            const std::string value = requireValue(argc, argv, i);
+            if (value == "off") {
+                config.cycleAction = CycleAction::Off;
+            }
+            else if (value == "report") {
+                config.cycleAction = CycleAction::Report;
+            }
+            else if (value == "stop") {
+                config.cycleAction = CycleAction::Stop;
+            }
+            else if (value == "fast-forward") {
+                config.cycleAction = CycleAction::FastForward;
+            }
+            else {
+                throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + arg + " " + value + ")");
+            }
+        }
+        else if (arg == "--stats") {
+            config.statsPath = requireValue(argc, argv, i);
+        }
+        else if (arg == "--rate") {
+            config.generationsPerSecond = parseDouble(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--catch-up") {
+            config.maxCatchUp = unsigned(std::min<uint64_t>(parseUnsigned(arg, requireValue(argc, argv, i)), 1000));
+        }
+        else if (arg == "--full-upload-threshold") {
+            config.fullUploadFraction = std::min(parseDouble(arg, requireValue(argc, argv, i)), 1.0);
+        }
+        else if (arg == "--gpu-tile-size") {
+            const std::string value = requireValue(argc, argv, i);
+            config.gpuTileSize = size_t(parseUnsigned(arg, value));
+            // tiles must start on BitGrid word boundaries
+            if (config.gpuTileSize % 64 != 0) {
+                throw std::runtime_error("FAILURE::INVALID_ARGUMENT_VALUE(" + arg + " " + value + ")");
+            }
+        }
+        else if (arg == "--age-colors") {
+            config.ageColors = true;
+        }
+        else if (arg == "--size") {
+            parseSize(arg, requireValue(argc, argv, i), config.boardWidth, config.boardHeight);
+        }
+        else if (arg == "--seed") {
+            config.seed = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--gpu-batch") {
+            config.gpuBatchBoards = size_t(parseUnsigned(arg, requireValue(argc, argv, i)));
+        }
+        else if (arg == "--bench") {
+            config.benchmarkGenerations = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--perf-counters") {
+            config.benchmarkCounters = true;
+        }
+        else if (arg == "--soups") {
+            config.soupCount = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--soup-threads") {
+            config.soupThreads = unsigned(std::min<uint64_t>(parseUnsigned(arg, requireValue(argc, argv, i)), 1024));
+        }
+        else if (arg == "--census") {
+            config.censusPath = requireValue(argc, argv, i);
+        }
+        else if (arg == "--pattern-store") {
+            config.patternStorePath = requireValue(argc, argv, i);
+        }
+        else if (arg == "--object-distance") {
+            config.objectDistance = unsigned(std::clamp<uint64_t>(parseUnsigned(arg, requireValue(argc, argv, i)), 1, 64));
+        }
+        else if (arg == "--label-objects") {
+            config.benchmarkObjects = true;
+        }
+        else if (arg == "--terminal") {
+            config.terminal = true;
+        }
+        else if (arg == "--terminal-fps") {
+            config.terminalFps = std::clamp(parseDouble(arg, requireValue(argc, argv, i)), 1.0, 120.0);
+        }
+        else if (arg == "--checkpoint-every") {
+            config.checkpointInterval = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--checkpoint-dir") {
+            config.checkpointDirectory = requireValue(argc, argv, i);
+        }
+        else if (arg == "--checkpoint-max-pending") {
+            config.checkpointMaxPending = size_t(parseUnsigned(arg, requireValue(argc, argv, i)));
+        }
+        else if (arg == "--resume") {
+            config.resumeFrom = requireValue(argc, argv, i);
+        }
+        else if (arg == "--record") {
+            config.recordPath = requireValue(argc, argv, i);
+        }
+        else if (arg == "--replay") {
+            config.replayPath = requireValue(argc, argv, i);
+        }
+        else if (arg == "--keyframe-every") {
+            config.keyframeInterval = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--rewind-every") {
+            config.rewindInterval = parseUnsigned(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--rewind-memory") {
+            config.rewindMemoryMiB = size_t(parseUnsigned(arg, requireValue(argc, argv, i)));
+        }
+        else if (arg == "--metrics-interval") {
+            config.metricsInterval = parseDouble(arg, requireValue(argc, argv, i));
+        }
+        else if (arg == "--trace") {
+            config.tracePath = requireValue(argc, argv, i);
+        }
+        else {
+            throw std::runtime_error("FAILURE::UNKNOWN_ARGUMENT(" + arg + ")");
+        }
+    }
+    return config;
+}
+
+void PrintUsage() {
+    std::cout <<
+        "Usage: GameOfLife [options]\n"
+        "  --help                        show this message\n"
+        "  --engine gpu|cpu              simulate in a fragment shader, or on a CPU thread (default: gpu)\n"
+        "  --on-cycle <action>           cpu engine: when the board repeats (still lifes, oscillators)\n"
+        "                                off | report | stop | fast-forward (--bench jumps to the last\n"
+        "                                generation, otherwise as stop) (default: off)\n"
+        "  --stats <file>                write population, births, deaths and bounding box of every generation;\n"
+        "                                CSV when the name ends in .csv, compact binary records otherwise;\n"
+        "                                the gpu engine stepping more than 8 generations per frame (high --rate)\n"
+        "                                waits on the GPU for the oldest pending stats instead of skipping any\n"
+        "  --rate <n>                    generations per second, 0 = unlimited (default: 10)\n"
+        "                                (space pauses, N steps a single generation)\n"
+        "  --catch-up <n>                extra generations run to catch up after a stall, 0 = drop them (default: 0)\n"
+        "  --full-upload-threshold <f>   cpu engine: fraction of changed tiles above which the whole board\n"
+        "                                is uploaded instead of just the changed tiles (default: 0.25)\n"
+        "  --gpu-tile-size <n>           gpu engine: split the board into n x n cell textures (multiple of 64),\n"
+        "                                0 = one texture when the board fits (default: 0)\n"
+        "  --age-colors                  gpu engine: colour live cells by how many generations they survived\n"
+        "  --size <w>x<h>                board size in cells (default: 256x256)\n"
+        "  --seed <n>                    seed for the initial board, 0 = random (default: 0)\n"
+        "  --boundary <mode>             dead: the outermost ring stays dead; torus: opposite edges are joined;\n"
+        "                                klein: as torus, with top and bottom joined mirrored; mirror: the edge\n"
+        "                                cells are reflected outwards (default: dead)\n"
+        "  --grow                        cpu engine and --bench, dead boundary: enlarge the board in 64 cell\n"
+        "                                steps whenever live cells come near an edge, so --size is only a start\n"
+        "  --shrink                      as --grow, and also give back empty 64 cell strips along the edges\n"
+        "  --bench <n>                   headless: step the board n generations on the CPU and report throughput\n"
+        "  --gpu-batch <n>               step n boards of --size together on the gpu for --bench generations\n"
+        "                                (default: 1000), reading their populations back as they go\n"
+        "  --perf-counters               with --bench, also read hardware performance counters (Linux)\n"
+        "  --soups <n>                   headless: run n random 16x16 soups until they settle and print a census\n"
+        "                                of the objects left behind (--seed picks the soup sequence)\n"
+        "  --soup-threads <n>            soup search threads, 0 = one per hardware thread (default: 0)\n"
+        "  --census <file>               with --soups, also write the whole census as CSV\n"
+        "  --pattern-store <file>        with --soups, add every still life and oscillator found to this file,\n"
+        "                                kept once per shape in any orientation across runs\n"
+        "  --object-distance <n>         live cells at most n apart (either axis) belong to one object; 2 keeps\n"
+        "                                pseudo-objects such as two blocks one cell apart together (default: 1)\n"
+        "  --label-objects               with --bench, also split the final board into objects and time it\n"
+        "  --terminal                    no window: run the cpu engine and draw the board as braille in the\n"
+        "                                terminal, sending only changed characters (Ctrl+C quits)\n"
+        "  --terminal-fps <n>            terminal frames per second (default: 15)\n"
+        "  --checkpoint-every <n>        write a checkpoint every n generations (0 = off)\n"
+        "  --checkpoint-dir <path>       directory for checkpoint files (default: checkpoints)\n"
+        "  --checkpoint-max-pending <n>  checkpoints queued before new ones are dropped (default: 2)\n"
+        "  --resume <file>               start from a checkpoint file\n"
+        "  --record <file>               record the whole run as compressed history, written as it runs\n"
+        "  --keyframe-every <n>          history frames between keyframes (default: 64)\n"
+        "  --replay <file>               open a --record file paused at its first generation; left/right step\n"
+        "                                through it, resuming continues from its last generation\n"
+        "  --rewind-every <n>            generations between stored rewind frames (default: 16)\n"
+        "  --rewind-memory <MiB>         memory for rewinding with left/right, 0 = off (default: 64)\n"
+        "  --metrics-interval <s>        seconds between frame/step/present latency reports,\n"
+        "                                0 = only at shutdown (default: 5)\n"
+        "  --trace <file>                record timing zones from startup and write Chrome trace JSON on exit\n"
+        "                                (F9 toggles recording, F10 writes the trace at any time)\n";
+}
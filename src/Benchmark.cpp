@@ -0,0 +1,163 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+#include <BitGrid.h>
+#include <BoardGrowth.h>
+#include <BoardHash.h>
+#include <CycleDetector.h>
+#include <LifeRule.h>
+#include <ObjectLabeler.h>
+#include <PerfCounters.h>
+#include <RandomGenerator.h>
+
+namespace {
+    const double CACHE_LINE_BYTES = 64.0;
+    const uint64_t WARMUP_GENERATIONS = 8;
+}
+
+int RunBenchmark(const AppConfig& config) {
+    const uint64_t generations = config.benchmarkGenerations;
+    const uint64_t seed = config.seed ? config.seed : 1;
+
+    BitGrid current(config.boardWidth, config.boardHeight);
+    BitGrid next(config.boardWidth, config.boardHeight);
+    RandomGenerator rng(seed);
+    rng.fillGridWithNoise(current);
+
+    std::printf("Benchmark: %ux%u board, %s boundary, %llu generations, seed %llu\n", config.boardWidth, config.boardHeight,
+        BoundaryName(config.boundary), (unsigned long long)generations, (unsigned long long)seed);
+
+    // touch every page and let the clocks ramp up before measuring
+    for (uint64_t i = 0; i < WARMUP_GENERATIONS; i++) {
+        LifeRule::Step(current, next, config.boundary);
+        std::swap(current, next);
+    }
+
+    PerfCounters counters;
+    const bool useCounters = config.benchmarkCounters && counters.AnyAvailable();
+    if (config.benchmarkCounters && !counters.AnyAvailable()) {
+        std::printf("  counters    unavailable: %s\n", counters.UnavailableReason().c_str());
+    }
+
+    if (useCounters) {
+        counters.Start();
+    }
+    // cycle detection keeps the hash up to date from the words each step changes
+    const bool detectCycles = config.cycleAction != CycleAction::Off;
+    CycleDetector cycles;
+    DirtyTiles changed;
+    uint64_t hash = 0;
+    if (detectCycles) {
+        hash = BoardHash::Full(current);
+        cycles.Observe(WARMUP_GENERATIONS, hash, current);
+    }
+    const bool grows = config.growBoard && config.boundary == Boundary::Dead;
+    BoardGrowth growth = grows ? BoardGrowth(config.shrinkBoard) : BoardGrowth();
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t target = generations, stepped = 0, skipped = 0;
+    // a growing board changes size, so the cells are counted as they are stepped
+    double cellUpdates = 0.0;
+    while (stepped < target) {
+        cellUpdates += double(current.Width()) * double(current.Height());
+        if (grows) {
+            // the stats step finds the bounding box growth needs
+            BoardStats stats;
+            LifeRule::Step(current, next, changed, hash, stats, config.boundary);
+            if (growth.Fit(next, stats)) {
+                hash = BoardHash::Full(next);
+                cycles.Reset();
+            }
+        }
+        else if (detectCycles) {
+            LifeRule::Step(current, next, changed, hash, config.boundary);
+        }
+        else {
+            LifeRule::Step(current, next, config.boundary);
+        }
+        std::swap(current, next);
+        stepped++;
+
+        if (detectCycles && cycles.Observe(WARMUP_GENERATIONS + stepped, hash, current)) {
+            if (config.cycleAction == CycleAction::Stop) {
+                break;
+            }
+            if (config.cycleAction == CycleAction::FastForward) {
+                // whole periods change nothing; only the remainder still has to be stepped
+                skipped = (target - stepped) / cycles.Period() * cycles.Period();
+                target -= skipped;
+            }
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (useCounters) {
+        counters.Stop();
+    }
+
+    const double seconds = elapsed.count();
+    std::printf("  time        %.3f s\n", seconds);
+    if (seconds > 0.0 && cellUpdates > 0.0) {
+        std::printf("  throughput  %.1f gens/s, %.2f Gcells/s, %.4f ns/cell\n",
+            double(stepped) / seconds, cellUpdates / seconds * 1e-9, seconds * 1e9 / cellUpdates);
+    }
+    if (grows) {
+        std::printf("  board       %zux%zu after %llu resizes, origin %lld,%lld\n", current.Width(), current.Height(),
+            (unsigned long long)growth.Resizes(), (long long)growth.OriginX(), (long long)growth.OriginY());
+    }
+    if (cycles.Found()) {
+        std::printf("  cycle       period %llu, found at generation %llu\n",
+            (unsigned long long)cycles.Period(), (unsigned long long)cycles.FoundAt());
+        if (stepped < generations) {
+            std::printf("  stepped     %llu of %llu generations%s\n", (unsigned long long)stepped, (unsigned long long)generations,
+                skipped > 0 ? " (the rest fast-forwarded)" : " (stopped)");
+        }
+    }
+    else if (detectCycles) {
+        std::printf("  cycle       none found\n");
+    }
+
+    if (useCounters && cellUpdates > 0.0) {
+        uint64_t values[PerfCounters::CounterCount] = {};
+        bool have[PerfCounters::CounterCount] = {};
+        for (int i = 0; i < PerfCounters::CounterCount; i++) {
+            have[i] = counters.Read(PerfCounters::Counter(i), values[i]);
+            if (have[i]) {
+                std::printf("  %-11s %.4f per cell (%llu total)\n", PerfCounters::Name(PerfCounters::Counter(i)),
+                    double(values[i]) / cellUpdates, (unsigned long long)values[i]);
+            }
+            else {
+                std::printf("  %-11s unavailable\n", PerfCounters::Name(PerfCounters::Counter(i)));
+            }
+        }
+        if (have[PerfCounters::Cycles] && have[PerfCounters::Instructions] && values[PerfCounters::Cycles] > 0) {
+            std::printf("  IPC         %.2f\n", double(values[PerfCounters::Instructions]) / double(values[PerfCounters::Cycles]));
+        }
+        // every last-level miss moves one line from memory; prefetched lines are not counted,
+        // so this is a lower bound on DRAM traffic
+        if (have[PerfCounters::LlcMisses]) {
+            const double bytes = double(values[PerfCounters::LlcMisses]) * CACHE_LINE_BYTES;
+            std::printf("  memory      %.4f bytes/cell, %.2f GB/s (from LLC misses)\n", bytes / cellUpdates, bytes / seconds * 1e-9);
+        }
+    }
+
+    if (config.benchmarkObjects) {
+        ObjectLabeler labeler(config.objectDistance);
+        const auto labelStart = std::chrono::steady_clock::now();
+        const std::vector<LabeledObject>& objects = labeler.Label(current);
+        const std::chrono::duration<double> labelTime = std::chrono::steady_clock::now() - labelStart;
+        uint64_t largest = 0;
+        for (const LabeledObject& object : objects) {
+            largest = std::max(largest, object.population);
+        }
+        std::printf("  objects     %zu (distance %u, largest %llu cells) labelled in %.3f s\n", objects.size(),
+            config.objectDistance, (unsigned long long)largest, labelTime.count());
+    }
+
+    // printed so the work cannot be optimized away, and to compare runs with the same seed
+    std::printf("  population  %llu\n", (unsigned long long)current.Population());
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "BitGrid.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+BitGrid::BitGrid(size_t width, size_t height) {
+    Resize(width, height);
+}
+
+void BitGrid::Resize(size_t width, size_t height) {
+    this->width = width;
+    this->height = height;
+    this->wordsPerRow = (width + 63) / 64;
+    this->words.assign(this->wordsPerRow * height, 0);
+}
+
+void BitGrid::Clear() {
+    std::fill(this->words.begin(), this->words.end(), 0);
+}
+
+uint64_t BitGrid::LastWordMask() const {
+    const size_t tail = this->width % 64;
+    return tail == 0 ? ~0ull : (1ull << tail) - 1;
+}
+
+uint64_t BitGrid::Population() const {
+    uint64_t population = 0;
+    for (uint64_t word : this->words) {
+        population += std::popcount(word);
+    }
+    return population;
+}
+
+void BitGrid::FromFloatGrid(const std::vector<float>& grid) {
+    assert(grid.size() == this->width * this->height);
+    Clear();
+    for (size_t y = 0; y < this->height; y++) {
+        const float* cells = grid.data() + y * this->width;
+        uint64_t* row = Row(y);
+        for (size_t x = 0; x < this->width; x++) {
+            // same threshold the shaders use
+            row[x / 64] |= uint64_t(cells[x] > .5f) << (x % 64);
+        }
+    }
+}
+
+void BitGrid::ToFloatGrid(std::vector<float>& grid) const {
+    grid.resize(this->width * this->height);
+    for (size_t y = 0; y < this->height; y++) {
+        float* cells = grid.data() + y * this->width;
+        const uint64_t* row = Row(y);
+        for (size_t x = 0; x < this->width; x++) {
+            cells[x] = float((row[x / 64] >> (x % 64)) & 1ull);
+        }
+    }
+}
@@ -0,0 +1,305 @@
+#include "BoardBatchShader.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <iostream>
+
+#include <Trace.h>
+
+BoardBatchShader::BoardBatchShader(const char* vertexPath, Boundary boundary)
+    : Shader(vertexPath, "src/shaders/batch_step.frag", BoundaryDefine(boundary)), countShader(vertexPath, "src/shaders/batch_count.frag"),
+      sumShader(vertexPath, "src/shaders/batch_sum.frag") {}
+
+BoardBatchShader::~BoardBatchShader() {
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteBuffers(1, &this->EBO);
+    glDeleteVertexArrays(1, &this->VAO);
+    for (Batch& batch : this->batches) {
+        glDeleteFramebuffers(2, batch.FBOs);
+        glDeleteTextures(2, batch.textures);
+    }
+
+    for (Readback& slot : this->populationSlots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.PBO);
+    }
+    glDeleteFramebuffers(1, &this->countFBO);
+    glDeleteTextures(1, &this->countPlanes);
+    glDeleteFramebuffers(1, &this->sumFBO);
+    glDeleteTextures(1, &this->sumTexture);
+    glDeleteProgram(this->countShader.ID);
+    glDeleteProgram(this->sumShader.ID);
+    glDeleteProgram(this->ID);
+}
+
+void BoardBatchShader::Initialize(size_t width, size_t height, size_t boards) {
+    // the population sums put every board of every batch side by side in one texture
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    const size_t limit = size_t(maxTextureSize) / BOARDS_PER_TEXTURE * BOARDS_PER_TEXTURE;
+    if (boards > limit) {
+        std::cout << "ERROR::BOARD_BATCH::TOO_MANY_BOARDS(" << boards << " > " << limit << ")" << std::endl;
+        boards = limit;
+    }
+    this->width = width;
+    this->height = height;
+    this->boards = boards;
+
+    use();
+    setInt("boards", 0);
+    setIVec2("gridSize", glm::ivec2(width, height));
+
+    createQuad();
+
+    this->batches.resize((boards + BOARDS_PER_TEXTURE - 1) / BOARDS_PER_TEXTURE);
+    const GLuint zero[4] = { 0, 0, 0, 0 };
+    for (Batch& batch : this->batches) {
+        glGenTextures(2, batch.textures);
+        glGenFramebuffers(2, batch.FBOs);
+        for (size_t i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, batch.textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, GLsizei(width), GLsizei(height), 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+            // integer textures are incomplete with linear filtering
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, batch.FBOs[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, batch.textures[i], 0);
+            glClearBufferuiv(GL_COLOR, 0, zero);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void BoardBatchShader::ProvideBoards(const std::vector<BitGrid>& boards) {
+    // bit b of component c of a texel is board 32 * c + b of the batch
+    std::vector<GLuint> texels;
+    for (size_t batch = 0; batch < this->batches.size(); batch++) {
+        texels.assign(this->width * this->height * 4, 0);
+        const size_t first = batch * BOARDS_PER_TEXTURE;
+        for (size_t board = first; board < std::min(first + BOARDS_PER_TEXTURE, boards.size()); board++) {
+            const BitGrid& grid = boards[board];
+            assert(grid.Width() == this->width && grid.Height() == this->height);
+            const size_t component = (board - first) / 32;
+            const GLuint bit = GLuint(1) << ((board - first) % 32);
+            for (size_t y = 0; y < this->height; y++) {
+                const uint64_t* row = grid.Row(y);
+                for (size_t i = 0; i < grid.WordsPerRow(); i++) {
+                    for (uint64_t word = row[i]; word != 0; word &= word - 1) {
+                        const size_t x = i * 64 + size_t(std::countr_zero(word));
+                        texels[(y * this->width + x) * 4 + component] |= bit;
+                    }
+                }
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, this->batches[batch].textures[this->current]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLsizei(this->width), GLsizei(this->height), GL_RGBA_INTEGER, GL_UNSIGNED_INT, texels.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void BoardBatchShader::ReadBoard(size_t board, BitGrid& grid) {
+    if (grid.Width() != this->width || grid.Height() != this->height) {
+        grid.Resize(this->width, this->height);
+    }
+    grid.Clear();
+    if (board >= this->boards) {
+        return;
+    }
+    std::vector<GLuint> texels(this->width * this->height * 4);
+    glBindTexture(GL_TEXTURE_2D, this->batches[board / BOARDS_PER_TEXTURE].textures[this->current]);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const size_t component = (board % BOARDS_PER_TEXTURE) / 32, bit = board % 32;
+    for (size_t y = 0; y < this->height; y++) {
+        for (size_t x = 0; x < this->width; x++) {
+            if ((texels[(y * this->width + x) * 4 + component] >> bit) & 1) {
+                grid.Set(x, y, true);
+            }
+        }
+    }
+}
+
+void BoardBatchShader::RunSimulation() {
+    TRACE_ZONE("BoardBatchShader::RunSimulation");
+    use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->VAO);
+    glViewport(0, 0, GLsizei(this->width), GLsizei(this->height));
+
+    const size_t next = this->current ^ 1;
+    for (Batch& batch : this->batches) {
+        glBindFramebuffer(GL_FRAMEBUFFER, batch.FBOs[next]);
+        glBindTexture(GL_TEXTURE_2D, batch.textures[this->current]);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    this->current = next;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool BoardBatchShader::RequestPopulations(uint64_t generation) {
+    if (!this->countFBO) {
+        createPopulationResources();
+    }
+    if (this->populationCount == POPULATION_SLOTS) {
+        return false;
+    }
+    TRACE_ZONE("BoardBatchShader::RequestPopulations");
+    Readback& slot = this->populationSlots[(this->populationHead + this->populationCount) % POPULATION_SLOTS];
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->VAO);
+    for (size_t batch = 0; batch < this->batches.size(); batch++) {
+        // the segment counts of this batch, then its boards' columns of the sums
+        glBindFramebuffer(GL_FRAMEBUFFER, this->countFBO);
+        glViewport(0, 0, GLsizei(this->segments), GLsizei(this->height));
+        this->countShader.use();
+        glBindTexture(GL_TEXTURE_2D, this->batches[batch].textures[this->current]);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, this->sumFBO);
+        glViewport(GLint(batch * BOARDS_PER_TEXTURE), 0, GLsizei(BOARDS_PER_TEXTURE), GLsizei(this->bands));
+        this->sumShader.use();
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->countPlanes);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    // with a pack buffer bound glReadPixels only queues the copy and returns immediately
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    glReadPixels(0, 0, GLsizei(this->batches.size() * BOARDS_PER_TEXTURE), GLsizei(this->bands), GL_RED_INTEGER, GL_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.generation = generation;
+    this->populationCount++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+bool BoardBatchShader::PollPopulations(uint64_t& generation, std::vector<uint64_t>& populations, bool wait) {
+    if (this->populationCount == 0) {
+        return false;
+    }
+    Readback& slot = this->populationSlots[this->populationHead];
+
+    const GLuint64 timeout = wait ? GLuint64(1000000000) : 0;
+    const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    this->populationHead = (this->populationHead + 1) % POPULATION_SLOTS;
+    this->populationCount--;
+    if (status == GL_WAIT_FAILED) {
+        return false;
+    }
+
+    // one row of board columns per band of rows
+    const size_t columns = this->batches.size() * BOARDS_PER_TEXTURE;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    const GLint* data = static_cast<const GLint*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+        columns * this->bands * sizeof(GLint), GL_MAP_READ_BIT));
+    if (data) {
+        populations.assign(this->boards, 0);
+        for (size_t band = 0; band < this->bands; band++) {
+            for (size_t board = 0; board < this->boards; board++) {
+                populations[board] += uint64_t(data[band * columns + board]);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    generation = slot.generation;
+    return data != nullptr;
+}
+
+void BoardBatchShader::createQuad() {
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    glGenBuffers(1, &this->EBO);
+
+    glBindVertexArray(this->VAO);
+
+    // a full-screen quad; the fragments are addressed through gl_FragCoord only
+    const float vertices[] = {
+         1.0f,  1.0f, 0.0f,  1.0f, 1.0f,
+         1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
+        -1.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+        -1.0f,  1.0f, 0.0f,  0.0f, 1.0f
+    };
+    const unsigned int indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+}
+
+void BoardBatchShader::createPopulationResources() {
+    this->segments = (this->width + COUNT_SEGMENT - 1) / COUNT_SEGMENT;
+    this->bands = (this->height + SUM_ROWS - 1) / SUM_ROWS;
+
+    this->countShader.use();
+    this->countShader.setInt("boards", 0);
+    this->countShader.setIVec2("gridSize", glm::ivec2(this->width, this->height));
+    this->sumShader.use();
+    this->sumShader.setInt("planes", 0);
+    this->sumShader.setIVec2("gridSize", glm::ivec2(this->width, this->height));
+    this->sumShader.setInt("segments", int(this->segments));
+
+    // batches are counted one after another through planes sized for one
+    glGenTextures(1, &this->countPlanes);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, this->countPlanes);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA32UI, GLsizei(this->segments), GLsizei(this->height), GLsizei(COUNT_PLANES), 0,
+        GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &this->countFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->countFBO);
+    GLenum drawBuffers[COUNT_PLANES];
+    for (size_t plane = 0; plane < COUNT_PLANES; plane++) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GLenum(GL_COLOR_ATTACHMENT0 + plane), this->countPlanes, 0, GLint(plane));
+        drawBuffers[plane] = GLenum(GL_COLOR_ATTACHMENT0 + plane);
+    }
+    glDrawBuffers(GLsizei(COUNT_PLANES), drawBuffers);
+
+    const size_t columns = this->batches.size() * BOARDS_PER_TEXTURE;
+    glGenTextures(1, &this->sumTexture);
+    glBindTexture(GL_TEXTURE_2D, this->sumTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, GLsizei(columns), GLsizei(this->bands), 0, GL_RED_INTEGER, GL_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &this->sumFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->sumFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->sumTexture, 0);
+
+    const size_t bytes = columns * this->bands * sizeof(GLint);
+    for (Readback& slot : this->populationSlots) {
+        glGenBuffers(1, &slot.PBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,61 @@
+#include "BoardGrowth.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+int64_t BoardGrowth::sideChange(int64_t distance) const {
+    const int64_t chunk = int64_t(CHUNK), room = int64_t(MARGIN + CHUNK);
+    if (distance < int64_t(MARGIN)) {
+        return (room - distance + chunk - 1) / chunk * chunk;
+    }
+    if (this->shrink && distance >= room + int64_t(SHRINK_SLACK)) {
+        return -((distance - room) / chunk * chunk);
+    }
+    return 0;
+}
+
+bool BoardGrowth::Fit(BitGrid& grid, BoardStats& stats) {
+    if (!this->enabled || stats.population == 0) {
+        return false;
+    }
+    const int64_t width = int64_t(grid.Width()), height = int64_t(grid.Height());
+    int64_t left = sideChange(stats.minX), right = sideChange(width - 1 - stats.maxX);
+    int64_t bottom = sideChange(stats.minY), top = sideChange(height - 1 - stats.maxY);
+    // widths stay whole chunks once the board has been resized
+    int64_t newWidth = (width + left + right + int64_t(CHUNK) - 1) / int64_t(CHUNK) * int64_t(CHUNK);
+    int64_t newHeight = (height + bottom + top + int64_t(CHUNK) - 1) / int64_t(CHUNK) * int64_t(CHUNK);
+    if (newWidth > int64_t(MAX_SIZE)) {
+        left = 0;
+        newWidth = width;
+    }
+    if (newHeight > int64_t(MAX_SIZE)) {
+        bottom = 0;
+        newHeight = height;
+    }
+    if (newWidth == width && newHeight == height && left == 0 && bottom == 0) {
+        return false;
+    }
+
+    // left is a whole number of words, so every row moves by whole words
+    this->resized.Resize(size_t(newWidth), size_t(newHeight));
+    const int64_t oldWords = int64_t(grid.WordsPerRow()), newWords = int64_t(this->resized.WordsPerRow());
+    const int64_t wordShift = left / 64;
+    const int64_t firstWord = std::max<int64_t>(0, -wordShift), endWord = std::min(oldWords, newWords - wordShift);
+    for (int64_t y = std::max<int64_t>(0, -bottom); y < height && y + bottom < newHeight; y++) {
+        if (endWord > firstWord) {
+            std::memcpy(this->resized.Row(size_t(y + bottom)) + firstWord + wordShift, grid.Row(size_t(y)) + firstWord,
+                size_t(endWord - firstWord) * sizeof(uint64_t));
+        }
+    }
+    std::swap(grid, this->resized);
+
+    stats.minX = uint32_t(stats.minX + left);
+    stats.maxX = uint32_t(stats.maxX + left);
+    stats.minY = uint32_t(stats.minY + bottom);
+    stats.maxY = uint32_t(stats.maxY + bottom);
+    this->originX -= left;
+    this->originY -= bottom;
+    this->resizes++;
+    return true;
+}
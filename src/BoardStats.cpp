@@ -0,0 +1,44 @@
+#include "BoardStats.h"
+
+#include <algorithm>
+#include <bit>
+
+BoardStats BoardStats::Of(const BitGrid& grid) {
+    BoardStats stats;
+    const size_t words = grid.WordsPerRow();
+    for (size_t y = 0; y < grid.Height(); y++) {
+        const uint64_t* row = grid.Row(y);
+        for (size_t i = 0; i < words; i++) {
+            if (row[i] == 0) {
+                continue;
+            }
+            BoardStats word;
+            word.population = uint64_t(std::popcount(row[i]));
+            word.minX = uint32_t(i * 64 + std::countr_zero(row[i]));
+            word.maxX = uint32_t(i * 64 + 63 - std::countl_zero(row[i]));
+            word.minY = word.maxY = uint32_t(y);
+            stats.Merge(word);
+        }
+    }
+    return stats;
+}
+
+void BoardStats::Merge(const BoardStats& part) {
+    if (part.population > 0) {
+        if (this->population == 0) {
+            this->minX = part.minX;
+            this->minY = part.minY;
+            this->maxX = part.maxX;
+            this->maxY = part.maxY;
+        }
+        else {
+            this->minX = std::min(this->minX, part.minX);
+            this->minY = std::min(this->minY, part.minY);
+            this->maxX = std::max(this->maxX, part.maxX);
+            this->maxY = std::max(this->maxY, part.maxY);
+        }
+    }
+    this->population += part.population;
+    this->births += part.births;
+    this->deaths += part.deaths;
+}
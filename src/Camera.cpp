@@ -0,0 +1,26 @@
+#include "Camera.h"
+
+#include <algorithm>
+
+void Camera::Fit(const glm::vec2& boardSize, const glm::vec2& viewportSize) {
+    this->center = boardSize * 0.5f;
+    this->pixelsPerCell = std::min(viewportSize.x / boardSize.x, viewportSize.y / boardSize.y);
+    // never zoom out further than a board 8 pixels across
+    this->minPixelsPerCell = std::min(this->pixelsPerCell, 8.0f / std::max(boardSize.x, boardSize.y));
+}
+
+void Camera::ZoomAt(float factor, const glm::vec2& screen, const glm::vec2& viewportSize) {
+    const glm::vec2 anchor = ScreenToCell(screen, viewportSize);
+    this->pixelsPerCell = std::clamp(this->pixelsPerCell * factor, this->minPixelsPerCell, MAX_PIXELS_PER_CELL);
+    // move the centre so the anchor cell is under the cursor again
+    this->center += anchor - ScreenToCell(screen, viewportSize);
+}
+
+void Camera::Pan(const glm::vec2& screenDelta) {
+    this->center -= glm::vec2(screenDelta.x, -screenDelta.y) / this->pixelsPerCell;
+}
+
+glm::vec2 Camera::ScreenToCell(const glm::vec2& screen, const glm::vec2& viewportSize) const {
+    const glm::vec2 fromCenter(screen.x - viewportSize.x * 0.5f, viewportSize.y * 0.5f - screen.y);
+    return this->center + fromCenter / this->pixelsPerCell;
+}
@@ -0,0 +1,191 @@
+#include "CheckpointWriter.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <AppConfig.h>
+#include <Trace.h>
+
+namespace {
+    const char CHECKPOINT_MAGIC[8] = { 'G', 'O', 'L', 'C', 'K', 'P', 'T', '1' };
+
+    struct CheckpointHeader {
+        char magic[8];
+        uint64_t generation;
+        uint32_t width;
+        uint32_t height;
+    };
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& directory, uint64_t interval, size_t maxPending)
+    : directory(directory), interval(interval), maxPending(maxPending) {
+    if (!Enabled()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+    if (error) {
+        std::cout << "ERROR::CHECKPOINT::CANNOT_CREATE_DIRECTORY(" << this->directory << "): " << error.message() << std::endl;
+    }
+
+    this->writer = std::thread(&CheckpointWriter::writerLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_one();
+    if (this->writer.joinable()) {
+        this->writer.join();
+    }
+}
+
+bool CheckpointWriter::Submit(GridSnapshotPtr snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stats.submitted++;
+        if (!Enabled() || this->pending.size() >= this->maxPending) {
+            this->stats.dropped++;
+            return false;
+        }
+        this->pending.push_back(std::move(snapshot));
+    }
+    this->wake.notify_one();
+    return true;
+}
+
+void CheckpointWriter::AddCaptureTime(double seconds) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.captureSeconds += seconds;
+}
+
+void CheckpointWriter::AddDropped() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.submitted++;
+    this->stats.dropped++;
+}
+
+CheckpointStats CheckpointWriter::Stats() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+void CheckpointWriter::PrintStats() const {
+    const CheckpointStats s = Stats();
+    const double captureMs = s.submitted ? 1000.0 * s.captureSeconds / s.submitted : 0.0;
+    const double writeMs = s.written ? 1000.0 * s.writeSeconds / s.written : 0.0;
+    std::cout << "Checkpoints: " << s.written << " written, " << s.dropped << " dropped, " << s.failed << " failed, "
+        << s.bytesWritten / (1024 * 1024) << " MiB | step loop " << captureMs << " ms/capture | writer "
+        << writeMs << " ms/checkpoint" << std::endl;
+}
+
+void CheckpointWriter::writerLoop() {
+    Trace::SetThreadName("checkpoint writer");
+    while (true) {
+        GridSnapshotPtr snapshot;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this]() { return this->stopping || !this->pending.empty(); });
+            if (this->pending.empty()) {
+                return;
+            }
+            snapshot = std::move(this->pending.front());
+            this->pending.pop_front();
+        }
+
+        TRACE_ZONE("write checkpoint");
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t bytes = 0;
+        const bool ok = writeSnapshot(*snapshot, bytes);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (ok) {
+            this->stats.written++;
+            this->stats.bytesWritten += bytes;
+        }
+        else {
+            this->stats.failed++;
+        }
+        this->stats.writeSeconds += elapsed.count();
+    }
+}
+
+bool CheckpointWriter::writeSnapshot(const GridSnapshot& snapshot, uint64_t& bytes) {
+    const std::filesystem::path target = std::filesystem::path(this->directory) / ("gen_" + std::to_string(snapshot.generation) + ".gol");
+    std::filesystem::path temporary = target;
+    temporary += ".tmp";
+
+    CheckpointHeader header;
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.generation = snapshot.generation;
+    header.width = uint32_t(snapshot.grid.Width());
+    header.height = uint32_t(snapshot.grid.Height());
+
+    const std::vector<uint64_t>& words = snapshot.grid.Words();
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+        if (!file) {
+            std::cout << "ERROR::CHECKPOINT::WRITE_FAILED(" << temporary.string() << ")" << std::endl;
+            return false;
+        }
+    }
+
+    // rename last so a crash mid-write never leaves a truncated checkpoint behind
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+        std::cout << "ERROR::CHECKPOINT::RENAME_FAILED(" << target.string() << "): " << error.message() << std::endl;
+        return false;
+    }
+
+    bytes = sizeof(header) + words.size() * sizeof(uint64_t);
+    return true;
+}
+
+bool CheckpointWriter::Load(const std::string& path, GridSnapshot& snapshot) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const uint64_t fileBytes = file ? uint64_t(file.tellg()) : 0;
+    file.seekg(0);
+    CheckpointHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        std::cout << "ERROR::CHECKPOINT::INVALID_FILE(" << path << ")" << std::endl;
+        return false;
+    }
+
+    // the size comes from the file, so check it before allocating the board
+    if (header.width < MIN_BOARD_SIZE || header.height < MIN_BOARD_SIZE ||
+        header.width > MAX_BOARD_SIZE || header.height > MAX_BOARD_SIZE) {
+        std::cout << "ERROR::CHECKPOINT::CORRUPT_FILE(" << path << ")" << std::endl;
+        return false;
+    }
+    const uint64_t boardBytes = (uint64_t(header.width) + 63) / 64 * header.height * sizeof(uint64_t);
+    if (fileBytes != sizeof(header) + boardBytes) {
+        std::cout << "ERROR::CHECKPOINT::" << (fileBytes < sizeof(header) + boardBytes ? "TRUNCATED_FILE(" : "CORRUPT_FILE(")
+            << path << ")" << std::endl;
+        return false;
+    }
+
+    snapshot.generation = header.generation;
+    snapshot.grid.Resize(header.width, header.height);
+    std::vector<uint64_t>& words = snapshot.grid.Words();
+    if (!file.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(uint64_t))) {
+        std::cout << "ERROR::CHECKPOINT::TRUNCATED_FILE(" << path << ")" << std::endl;
+        return false;
+    }
+    // BitGrid keeps the padding past the width zero; a damaged file may not
+    const uint64_t lastMask = snapshot.grid.LastWordMask();
+    for (size_t y = 0; y < snapshot.grid.Height(); y++) {
+        snapshot.grid.Row(y)[snapshot.grid.WordsPerRow() - 1] &= lastMask;
+    }
+    return true;
+}
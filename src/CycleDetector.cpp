@@ -0,0 +1,37 @@
+#include "CycleDetector.h"
+
+bool CycleDetector::Observe(uint64_t generation, uint64_t hash, const BitGrid& grid) {
+    if (this->period > 0) {
+        return false;
+    }
+    if (!this->hasSaved) {
+        save(generation, hash, grid);
+        return false;
+    }
+
+    const uint64_t distance = generation - this->savedGeneration;
+    if (hash == this->savedHash && grid == this->saved) {
+        this->period = distance;
+        this->foundAt = generation;
+        return true;
+    }
+    if (distance == this->power) {
+        save(generation, hash, grid);
+        this->power *= 2;
+    }
+    return false;
+}
+
+void CycleDetector::Reset() {
+    this->hasSaved = false;
+    this->power = 1;
+    this->period = 0;
+    this->foundAt = 0;
+}
+
+void CycleDetector::save(uint64_t generation, uint64_t hash, const BitGrid& grid) {
+    this->hasSaved = true;
+    this->savedGeneration = generation;
+    this->savedHash = hash;
+    this->saved = grid;
+}
@@ -0,0 +1,87 @@
+#include "DeltaCodec.h"
+
+#include <cstring>
+
+namespace {
+    void putVarint(uint64_t value, std::vector<uint8_t>& out) {
+        while (value >= 0x80) {
+            out.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    bool getVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (data == end) {
+                return false;
+            }
+            const uint8_t byte = *data++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // word(i) produces the i-th word to encode; shared by plain and XOR encoding
+    template <typename WordAt>
+    void encode(size_t count, std::vector<uint8_t>& out, WordAt word) {
+        size_t i = 0;
+        while (i < count) {
+            const size_t zeroStart = i;
+            while (i < count && word(i) == 0) {
+                i++;
+            }
+            if (i == count) {
+                // trailing zeros are implied, an unchanged board encodes to nothing
+                break;
+            }
+            const size_t literalStart = i;
+            while (i < count && word(i) != 0) {
+                i++;
+            }
+            putVarint(literalStart - zeroStart, out);
+            putVarint(i - literalStart, out);
+            const size_t offset = out.size();
+            out.resize(offset + (i - literalStart) * sizeof(uint64_t));
+            for (size_t j = literalStart; j < i; j++) {
+                const uint64_t value = word(j);
+                std::memcpy(out.data() + offset + (j - literalStart) * sizeof(uint64_t), &value, sizeof(uint64_t));
+            }
+        }
+    }
+}
+
+void DeltaCodec::EncodeWords(const uint64_t* words, size_t count, std::vector<uint8_t>& out) {
+    encode(count, out, [words](size_t i) { return words[i]; });
+}
+
+void DeltaCodec::EncodeXor(const uint64_t* current, const uint64_t* previous, size_t count, std::vector<uint8_t>& out) {
+    encode(count, out, [current, previous](size_t i) { return current[i] ^ previous[i]; });
+}
+
+bool DeltaCodec::DecodeXorInto(const uint8_t* data, size_t size, uint64_t* target, size_t count) {
+    const uint8_t* end = data + size;
+    size_t position = 0;
+    while (data != end) {
+        uint64_t zeros, literals;
+        if (!getVarint(data, end, zeros) || !getVarint(data, end, literals)) {
+            return false;
+        }
+        if (zeros > count - position || literals > count - position - zeros ||
+            literals * sizeof(uint64_t) > size_t(end - data)) {
+            return false;
+        }
+        position += zeros;
+        for (uint64_t j = 0; j < literals; j++) {
+            uint64_t value;
+            std::memcpy(&value, data, sizeof(uint64_t));
+            data += sizeof(uint64_t);
+            target[position++] ^= value;
+        }
+    }
+    return position <= count;
+}
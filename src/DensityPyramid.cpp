@@ -0,0 +1,213 @@
+#include "DensityPyramid.h"
+
+#include <algorithm>
+
+#include <Trace.h>
+
+namespace {
+    // number of set bits in each byte of x
+    inline uint64_t bytePopcounts(uint64_t x) {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    }
+
+    inline uint8_t toDensity(uint32_t count, size_t blockSide) {
+        return uint8_t((uint64_t(count) * 255 + blockSide * blockSide / 2) / (blockSide * blockSide));
+    }
+}
+
+DensityPyramid::~DensityPyramid() {
+    glDeleteTextures(1, &this->texture);
+}
+
+void DensityPyramid::Update(const EngineFrame& frame) {
+    const BitGrid& grid = frame.grid;
+    if (!this->valid || this->tilesX != grid.WordsPerRow() || this->tilesY != (grid.Height() + TILE_SIZE - 1) / TILE_SIZE) {
+        Rebuild(grid);
+        this->valid = true;
+        this->sequence = frame.sequence;
+        return;
+    }
+    if (frame.sequence == this->sequence) {
+        return;
+    }
+    TRACE_ZONE("DensityPyramid::Update");
+
+    this->dirtyTiles.clear();
+    for (size_t tile = 0; tile < frame.tileVersions.size(); tile++) {
+        if (frame.tileVersions[tile] > this->sequence) {
+            this->dirtyTiles.push_back(uint32_t(tile));
+        }
+    }
+    this->sequence = frame.sequence;
+    if (this->dirtyTiles.empty()) {
+        return;
+    }
+
+    for (uint32_t tile : this->dirtyTiles) {
+        countTile(grid, tile % this->tilesX, tile / this->tilesX);
+    }
+    rebuildCoarseLevels();
+
+    glBindTexture(GL_TEXTURE_2D, this->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // one upload per horizontal run of dirty tiles and fine level
+    for (size_t i = 0; i < this->dirtyTiles.size();) {
+        const size_t first = this->dirtyTiles[i];
+        size_t last = first;
+        i++;
+        while (i < this->dirtyTiles.size() && this->dirtyTiles[i] == last + 1 && (last + 1) % this->tilesX != 0) {
+            last = this->dirtyTiles[i];
+            i++;
+        }
+        uploadTile(first % this->tilesX, first / this->tilesX, last - first + 1);
+    }
+    for (size_t level = TILE_LEVELS; level < this->levels.size(); level++) {
+        uploadLevel(level);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DensityPyramid::Rebuild(const BitGrid& grid) {
+    TRACE_ZONE("DensityPyramid::Rebuild");
+    allocate(grid);
+    for (size_t tileY = 0; tileY < this->tilesY; tileY++) {
+        for (size_t tileX = 0; tileX < this->tilesX; tileX++) {
+            countTile(grid, tileX, tileY);
+        }
+    }
+    rebuildCoarseLevels();
+
+    glBindTexture(GL_TEXTURE_2D, this->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < this->levels.size(); level++) {
+        uploadLevel(level);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // the texture no longer matches any engine frame
+    this->valid = false;
+}
+
+void DensityPyramid::allocate(const BitGrid& grid) {
+    const size_t tilesX = grid.WordsPerRow();
+    const size_t tilesY = (grid.Height() + TILE_SIZE - 1) / TILE_SIZE;
+    if (this->texture && tilesX == this->tilesX && tilesY == this->tilesY) {
+        return;
+    }
+    this->tilesX = tilesX;
+    this->tilesY = tilesY;
+
+    // GL mip sizes: halve and round down until 1x1
+    this->levels.clear();
+    size_t width = tilesX * (TILE_SIZE / BASE_BLOCK), height = tilesY * (TILE_SIZE / BASE_BLOCK);
+    while (true) {
+        Level level;
+        level.width = width;
+        level.height = height;
+        level.counts.assign(width * height, 0);
+        level.density.assign(width * height, 0);
+        this->levels.push_back(std::move(level));
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = std::max<size_t>(width / 2, 1);
+        height = std::max<size_t>(height / 2, 1);
+    }
+
+    if (!this->texture) {
+        glGenTextures(1, &this->texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, this->texture);
+    for (size_t level = 0; level < this->levels.size(); level++) {
+        glTexImage2D(GL_TEXTURE_2D, GLint(level), GL_R8, GLsizei(this->levels[level].width), GLsizei(this->levels[level].height),
+            0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(this->levels.size() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DensityPyramid::countTile(const BitGrid& grid, size_t tileX, size_t tileY) {
+    const size_t blocksPerTile = TILE_SIZE / BASE_BLOCK;
+    Level& base = this->levels[0];
+
+    // a tile row is one word and a base block one byte of eight consecutive rows
+    for (size_t blockY = 0; blockY < blocksPerTile; blockY++) {
+        const size_t y0 = tileY * TILE_SIZE + blockY * BASE_BLOCK;
+        const size_t y1 = std::min(y0 + BASE_BLOCK, grid.Height());
+        uint64_t counts = 0;
+        for (size_t y = y0; y < y1; y++) {
+            // at most 8 per byte and row, so 8 rows cannot overflow a byte
+            counts += bytePopcounts(grid.Row(y)[tileX]);
+        }
+        uint32_t* out = base.counts.data() + (tileY * blocksPerTile + blockY) * base.width + tileX * blocksPerTile;
+        for (size_t b = 0; b < blocksPerTile; b++) {
+            out[b] = uint32_t((counts >> (b * 8)) & 0xFF);
+        }
+    }
+
+    // the finer levels only depend on this tile
+    for (size_t level = 0; level < TILE_LEVELS; level++) {
+        Level& current = this->levels[level];
+        const size_t side = blocksPerTile >> level;
+        if (level > 0) {
+            const Level& child = this->levels[level - 1];
+            for (size_t y = tileY * side; y < (tileY + 1) * side; y++) {
+                for (size_t x = tileX * side; x < (tileX + 1) * side; x++) {
+                    const uint32_t* top = child.counts.data() + 2 * y * child.width + 2 * x;
+                    const uint32_t* bottom = top + child.width;
+                    current.counts[y * current.width + x] = top[0] + top[1] + bottom[0] + bottom[1];
+                }
+            }
+        }
+        const size_t blockSide = BASE_BLOCK << level;
+        for (size_t y = tileY * side; y < (tileY + 1) * side; y++) {
+            for (size_t x = tileX * side; x < (tileX + 1) * side; x++) {
+                current.density[y * current.width + x] = toDensity(current.counts[y * current.width + x], blockSide);
+            }
+        }
+    }
+}
+
+void DensityPyramid::rebuildCoarseLevels() {
+    for (size_t level = TILE_LEVELS; level < this->levels.size(); level++) {
+        Level& current = this->levels[level];
+        const Level& child = this->levels[level - 1];
+        const size_t blockSide = BASE_BLOCK << level;
+        for (size_t y = 0; y < current.height; y++) {
+            for (size_t x = 0; x < current.width; x++) {
+                uint32_t count = 0;
+                for (size_t cy = 2 * y; cy < std::min(2 * y + 2, child.height); cy++) {
+                    for (size_t cx = 2 * x; cx < std::min(2 * x + 2, child.width); cx++) {
+                        count += child.counts[cy * child.width + cx];
+                    }
+                }
+                current.counts[y * current.width + x] = count;
+                current.density[y * current.width + x] = toDensity(count, blockSide);
+            }
+        }
+    }
+}
+
+void DensityPyramid::uploadTile(size_t tileX, size_t tileY, size_t tileCount) {
+    for (size_t level = 0; level < TILE_LEVELS && level < this->levels.size(); level++) {
+        const Level& current = this->levels[level];
+        const size_t side = (TILE_SIZE / BASE_BLOCK) >> level;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(current.width));
+        glTexSubImage2D(GL_TEXTURE_2D, GLint(level), GLint(tileX * side), GLint(tileY * side), GLsizei(tileCount * side), GLsizei(side),
+            GL_RED, GL_UNSIGNED_BYTE, current.density.data() + tileY * side * current.width + tileX * side);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void DensityPyramid::uploadLevel(size_t level) {
+    const Level& current = this->levels[level];
+    glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, GLsizei(current.width), GLsizei(current.height),
+        GL_RED, GL_UNSIGNED_BYTE, current.density.data());
+}
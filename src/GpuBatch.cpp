@@ -0,0 +1,141 @@
+#include "GpuBatch.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <BitGrid.h>
+#include <BoardBatchShader.h>
+#include <RandomGenerator.h>
+
+namespace {
+    // without --bench
+    const uint64_t DEFAULT_GENERATIONS = 1000;
+
+    // what the population readbacks told about every board so far
+    struct Ensemble {
+        std::vector<uint64_t> populations;
+        std::vector<uint64_t> diedAt;       // first generation seen empty, 0 = alive
+        uint64_t generation = 0;            // of populations
+        uint64_t readbacks = 0;
+
+        void Record(uint64_t sampleGeneration, const std::vector<uint64_t>& sample) {
+            this->diedAt.resize(sample.size(), 0);
+            for (size_t board = 0; board < sample.size(); board++) {
+                if (sample[board] == 0 && this->diedAt[board] == 0) {
+                    this->diedAt[board] = sampleGeneration;
+                }
+            }
+            this->populations = sample;
+            this->generation = sampleGeneration;
+            this->readbacks++;
+        }
+    };
+
+    int runBatch(const AppConfig& config) {
+        const uint64_t generations = config.benchmarkGenerations ? config.benchmarkGenerations : DEFAULT_GENERATIONS;
+        const uint64_t seed = config.seed ? config.seed : 1;
+
+        BoardBatchShader batch("src/shaders/shader.vert", config.boundary);
+        batch.Initialize(config.boardWidth, config.boardHeight, config.gpuBatchBoards);
+        {
+            std::vector<BitGrid> boards(batch.Boards());
+            for (size_t board = 0; board < boards.size(); board++) {
+                boards[board].Resize(config.boardWidth, config.boardHeight);
+                RandomGenerator rng(seed + board);
+                rng.fillGridWithNoise(boards[board]);
+            }
+            batch.ProvideBoards(boards);
+        }
+
+        std::printf("GPU batch: %zu boards of %ux%u, %s boundary, %llu generations, seed %llu\n", batch.Boards(), config.boardWidth,
+            config.boardHeight, BoundaryName(config.boundary), (unsigned long long)generations, (unsigned long long)seed);
+
+        Ensemble ensemble;
+        std::vector<uint64_t> sample;
+        uint64_t sampleGeneration = 0;
+        glFinish();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t generation = 1; generation <= generations; generation++) {
+            batch.RunSimulation();
+            // generations that find every slot busy are simply not sampled
+            batch.RequestPopulations(generation);
+            while (batch.PollPopulations(sampleGeneration, sample)) {
+                ensemble.Record(sampleGeneration, sample);
+            }
+        }
+        while (batch.HasPendingPopulations()) {
+            if (batch.PollPopulations(sampleGeneration, sample, true)) {
+                ensemble.Record(sampleGeneration, sample);
+            }
+        }
+        glFinish();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const double boardGenerations = double(generations) * double(batch.Boards());
+        std::printf("  time        %.3f s\n", seconds);
+        if (seconds > 0.0) {
+            std::printf("  throughput  %.0f board-generations/s, %.2f Gcells/s\n", boardGenerations / seconds,
+                boardGenerations * config.boardWidth * config.boardHeight / seconds * 1e-9);
+        }
+        std::printf("  sampled     %llu of %llu generations\n", (unsigned long long)ensemble.readbacks, (unsigned long long)generations);
+        if (ensemble.populations.empty()) {
+            return 0;
+        }
+
+        size_t died = 0;
+        uint64_t firstDeath = 0;
+        for (uint64_t diedAt : ensemble.diedAt) {
+            if (diedAt != 0) {
+                died++;
+                firstDeath = firstDeath ? std::min(firstDeath, diedAt) : diedAt;
+            }
+        }
+        if (died > 0) {
+            std::printf("  died out    %zu boards, the first by generation %llu\n", died, (unsigned long long)firstDeath);
+        }
+        const auto [lowest, highest] = std::minmax_element(ensemble.populations.begin(), ensemble.populations.end());
+        uint64_t total = 0;
+        for (uint64_t population : ensemble.populations) {
+            total += population;
+        }
+        std::printf("  population  min %llu, mean %.1f, max %llu at generation %llu\n", (unsigned long long)*lowest,
+            double(total) / ensemble.populations.size(), (unsigned long long)*highest, (unsigned long long)ensemble.generation);
+        return 0;
+    }
+}
+
+int RunGpuBatch(const AppConfig& config) {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    // only for the context
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "GameOfLife batch", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    // the shader's GL objects go before the context does
+    const int result = runBatch(config);
+    glfwTerminate();
+    return result;
+}
@@ -0,0 +1,98 @@
+#include "GpuTimer.h"
+
+#include <iostream>
+
+#include <Trace.h>
+
+GpuTimer::GpuTimer(Metrics& metrics) : metrics(metrics) {
+    // timer queries are core since 3.3, but some drivers report a zero-bit counter
+    GLint timestampBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+    GLint elapsedBits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &elapsedBits);
+    this->enabled = timestampBits > 0 && elapsedBits > 0;
+    if (!this->enabled) {
+        std::cout << "GPU timer queries unavailable, GPU pass timings disabled" << std::endl;
+        return;
+    }
+    this->queueMetric = this->metrics.Register("gpu queue");
+}
+
+GpuTimer::~GpuTimer() {
+    for (Pass& pass : this->passes) {
+        for (Query& query : pass.queries) {
+            glDeleteQueries(1, &query.elapsed);
+            glDeleteQueries(1, &query.finished);
+        }
+    }
+}
+
+size_t GpuTimer::AddPass(const std::string& name) {
+    Pass pass;
+    if (this->enabled) {
+        pass.metric = this->metrics.Register("gpu " + name);
+        for (Query& query : pass.queries) {
+            glGenQueries(1, &query.elapsed);
+            glGenQueries(1, &query.finished);
+        }
+    }
+    this->passes.push_back(pass);
+    return this->passes.size() - 1;
+}
+
+void GpuTimer::Begin(size_t pass) {
+    if (!this->enabled) {
+        return;
+    }
+    Pass& timed = this->passes[pass];
+    Query& query = timed.queries[timed.head];
+    if (query.pending) {
+        // the GPU is more than QUERY_SLOTS passes behind; skip rather than wait
+        this->dropped++;
+        return;
+    }
+    glGetInteger64v(GL_TIMESTAMP, &query.submitted);
+    glBeginQuery(GL_TIME_ELAPSED, query.elapsed);
+    timed.active = true;
+}
+
+void GpuTimer::End(size_t pass) {
+    Pass& timed = this->passes[pass];
+    if (!timed.active) {
+        return;
+    }
+    Query& query = timed.queries[timed.head];
+    glEndQuery(GL_TIME_ELAPSED);
+    glQueryCounter(query.finished, GL_TIMESTAMP);
+    query.pending = true;
+    timed.head = (timed.head + 1) % QUERY_SLOTS;
+    timed.active = false;
+}
+
+void GpuTimer::Collect() {
+    if (!this->enabled) {
+        return;
+    }
+    TRACE_ZONE("GpuTimer::Collect");
+    for (Pass& pass : this->passes) {
+        while (pass.queries[pass.tail].pending) {
+            Query& query = pass.queries[pass.tail];
+            // the timestamp is written after the elapsed query ends, so it is the later of the two
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query.finished, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                break;
+            }
+            GLuint64 elapsed = 0, finished = 0;
+            glGetQueryObjectui64v(query.elapsed, GL_QUERY_RESULT, &elapsed);
+            glGetQueryObjectui64v(query.finished, GL_QUERY_RESULT, &finished);
+
+            this->metrics.Record(pass.metric, elapsed);
+            const int64_t started = int64_t(finished) - int64_t(elapsed);
+            this->metrics.Record(this->queueMetric, started > query.submitted ? uint64_t(started - query.submitted) : 0);
+
+            query.pending = false;
+            pass.tail = (pass.tail + 1) % QUERY_SLOTS;
+        }
+    }
+}
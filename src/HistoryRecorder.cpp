@@ -0,0 +1,207 @@
+#include "HistoryRecorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <AppConfig.h>
+#include <DeltaCodec.h>
+#include <Trace.h>
+
+namespace {
+    const char HISTORY_MAGIC[8] = { 'G', 'O', 'L', 'H', 'I', 'S', 'T', '2' };
+
+    // written in front of every frame's encoded bytes; offsets follow from the order
+    struct FrameRecord {
+        uint64_t generation;
+        uint64_t size;
+        uint64_t keyframe;
+        uint32_t width;
+        uint32_t height;
+    };
+    static_assert(sizeof(FrameRecord) == 32, "frame records are written as is");
+}
+
+HistoryRecorder::HistoryRecorder(uint64_t keyframeInterval) : keyframeInterval(std::max<uint64_t>(keyframeInterval, 1)) {}
+
+HistoryRecorder::HistoryRecorder(uint64_t keyframeInterval, const std::string& path)
+    : keyframeInterval(std::max<uint64_t>(keyframeInterval, 1)), streaming(true), path(path) {
+    this->file = std::fopen(path.c_str(), "wb");
+    if (!this->file) {
+        std::cout << "ERROR::HISTORY::CANNOT_OPEN_FILE(" << path << ")" << std::endl;
+        return;
+    }
+    std::fwrite(HISTORY_MAGIC, sizeof(HISTORY_MAGIC), 1, this->file);
+    std::fwrite(&this->keyframeInterval, sizeof(this->keyframeInterval), 1, this->file);
+}
+
+HistoryRecorder::~HistoryRecorder() {
+    if (this->file) {
+        std::fclose(this->file);
+    }
+}
+
+void HistoryRecorder::Record(GridSnapshotPtr snapshot) {
+    if (this->streaming && !this->file) {
+        return;
+    }
+    TRACE_ZONE("HistoryRecorder::Record");
+    const auto start = std::chrono::steady_clock::now();
+    const BitGrid& grid = snapshot->grid;
+
+    Frame frame;
+    frame.generation = snapshot->generation;
+    frame.offset = this->data.size();
+    frame.width = uint32_t(grid.Width());
+    frame.height = uint32_t(grid.Height());
+
+    const uint64_t index = this->stats.frames;
+    const bool keyframe = !this->previous ||
+        this->previous->grid.Width() != grid.Width() || this->previous->grid.Height() != grid.Height() ||
+        index - this->lastKeyframe >= this->keyframeInterval;
+
+    const std::vector<uint64_t>& words = grid.Words();
+    if (keyframe) {
+        this->lastKeyframe = index;
+        DeltaCodec::EncodeWords(words.data(), words.size(), this->data);
+        this->stats.keyframes++;
+    }
+    else {
+        DeltaCodec::EncodeXor(words.data(), this->previous->grid.Words().data(), words.size(), this->data);
+    }
+    frame.keyframe = this->lastKeyframe;
+    frame.size = this->data.size() - frame.offset;
+    if (this->streaming) {
+        write(frame, keyframe);
+        this->data.clear();
+    }
+    else {
+        this->frames.push_back(frame);
+    }
+
+    // keep a reference instead of a copy; snapshots are immutable
+    this->previous = std::move(snapshot);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    this->stats.frames++;
+    this->stats.encodedBytes += frame.size;
+    this->stats.rawBytes += words.size() * sizeof(uint64_t);
+    this->stats.encodeSeconds += elapsed.count();
+}
+
+void HistoryRecorder::write(const Frame& frame, bool flush) {
+    const FrameRecord record = { frame.generation, frame.size, frame.keyframe, frame.width, frame.height };
+    bool written = std::fwrite(&record, sizeof(record), 1, this->file) == 1 &&
+        std::fwrite(this->data.data(), 1, this->data.size(), this->file) == this->data.size();
+    if (written && flush) {
+        written = std::fflush(this->file) == 0;
+    }
+    if (!written) {
+        std::cout << "ERROR::HISTORY::WRITE_FAILED(" << this->path << ")" << std::endl;
+        std::fclose(this->file);
+        this->file = nullptr;
+    }
+}
+
+bool HistoryRecorder::Seek(uint64_t generation, GridSnapshot& snapshot) const {
+    auto it = std::upper_bound(this->frames.begin(), this->frames.end(), generation,
+        [](uint64_t value, const Frame& frame) { return value < frame.generation; });
+    if (it == this->frames.begin()) {
+        return false;
+    }
+    const size_t target = size_t(it - this->frames.begin()) - 1;
+    const Frame& last = this->frames[target];
+
+    snapshot.generation = last.generation;
+    snapshot.grid.Resize(last.width, last.height);
+    std::vector<uint64_t>& words = snapshot.grid.Words();
+    for (size_t i = size_t(last.keyframe); i <= target; i++) {
+        const Frame& frame = this->frames[i];
+        if (!DeltaCodec::DecodeXorInto(this->data.data() + frame.offset, size_t(frame.size), words.data(), words.size())) {
+            std::cout << "ERROR::HISTORY::CORRUPT_FRAME(" << frame.generation << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void HistoryRecorder::PrintStats() const {
+    const double ratio = this->stats.encodedBytes ? double(this->stats.rawBytes) / double(this->stats.encodedBytes) : 0.0;
+    const double encodeMs = this->stats.frames ? 1000.0 * this->stats.encodeSeconds / this->stats.frames : 0.0;
+    std::cout << "History: " << this->stats.frames << " frames (" << this->stats.keyframes << " keyframes), "
+        << this->stats.encodedBytes / 1024 << " KiB, " << ratio << "x smaller than raw | "
+        << encodeMs << " ms/frame" << std::endl;
+}
+
+bool HistoryRecorder::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    const uint64_t fileBytes = file ? uint64_t(file.tellg()) : 0;
+    file.seekg(0);
+    char magic[sizeof(HISTORY_MAGIC)];
+    uint64_t interval = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, HISTORY_MAGIC, sizeof(magic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(&interval), sizeof(interval))) {
+        std::cout << "ERROR::HISTORY::INVALID_FILE(" << path << ")" << std::endl;
+        return false;
+    }
+
+    std::vector<Frame> loaded;
+    std::vector<uint8_t> loadedData;
+    uint64_t position = sizeof(magic) + sizeof(interval);
+    FrameRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        position += sizeof(record);
+
+        // Seek trusts every frame's keyframe index and size, so they are checked before the size
+        // turns into an allocation; the size also becomes the board size of a replay, so it is
+        // held to what --size accepts. A delta frame continues the frame before it.
+        const size_t index = loaded.size();
+        const bool keyframe = record.keyframe == index;
+        const bool valid = record.width >= MIN_BOARD_SIZE && record.height >= MIN_BOARD_SIZE &&
+            record.width <= MAX_BOARD_SIZE && record.height <= MAX_BOARD_SIZE &&
+            (keyframe || (index > 0 && record.keyframe == loaded.back().keyframe &&
+                record.width == loaded.back().width && record.height == loaded.back().height)) &&
+            (index == 0 || loaded.back().generation <= record.generation);
+        if (!valid) {
+            std::cout << "ERROR::HISTORY::CORRUPT_FILE(" << path << ", frame " << index << ")" << std::endl;
+            return false;
+        }
+        if (record.size > fileBytes - position) {
+            break;
+        }
+
+        Frame frame;
+        frame.generation = record.generation;
+        frame.offset = loadedData.size();
+        frame.size = record.size;
+        frame.keyframe = record.keyframe;
+        frame.width = record.width;
+        frame.height = record.height;
+        loadedData.resize(size_t(frame.offset + frame.size));
+        if (!file.read(reinterpret_cast<char*>(loadedData.data() + frame.offset), std::streamsize(frame.size))) {
+            break;
+        }
+        position += frame.size;
+        loaded.push_back(frame);
+    }
+    if (position != fileBytes) {
+        // the recording was killed mid-write; everything before the last frame is intact
+        std::cout << "History: " << path << " ends inside frame " << loaded.size() << ", which is left out" << std::endl;
+        loadedData.resize(loaded.empty() ? 0 : size_t(loaded.back().offset + loaded.back().size));
+    }
+
+    this->keyframeInterval = std::max<uint64_t>(interval, 1);
+    this->frames = std::move(loaded);
+    this->data = std::move(loadedData);
+    this->previous.reset();
+    this->stats = HistoryStats();
+    this->stats.frames = this->frames.size();
+    this->stats.encodedBytes = this->data.size();
+    for (const Frame& frame : this->frames) {
+        this->stats.keyframes += frame.keyframe == uint64_t(&frame - this->frames.data());
+        this->stats.rawBytes += ((frame.width + 63) / 64) * uint64_t(frame.height) * sizeof(uint64_t);
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+    const uint64_t SUB_BUCKETS = 64;   // 1 << SUB_BUCKET_BITS
+}
+
+LatencyHistogram::LatencyHistogram() : buckets(bucketIndex(UINT64_MAX) + 1, 0) {}
+
+// [0, 128) map to themselves; above that a value with its highest set bit at position msb
+// keeps its top 7 bits, giving 64 buckets per power of two
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < LINEAR_LIMIT) {
+        return size_t(value);
+    }
+    const int msb = 63 - std::countl_zero(value);
+    const int shift = msb - SUB_BUCKET_BITS;
+    return size_t(LINEAR_LIMIT + (shift - 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(size_t index) {
+    if (index < LINEAR_LIMIT) {
+        return index;
+    }
+    const size_t offset = index - size_t(LINEAR_LIMIT);
+    const int shift = int(offset / SUB_BUCKETS) + 1;
+    const uint64_t lower = (SUB_BUCKETS + offset % SUB_BUCKETS) << shift;
+    return lower + ((1ull << shift) >> 1);
+}
+
+void LatencyHistogram::Record(uint64_t valueNs) {
+    this->buckets[bucketIndex(valueNs)]++;
+    this->count++;
+    this->sum += valueNs;
+    this->min = std::min(this->min, valueNs);
+    this->max = std::max(this->max, valueNs);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < this->buckets.size(); i++) {
+        this->buckets[i] += other.buckets[i];
+    }
+    this->count += other.count;
+    this->sum += other.sum;
+    this->min = std::min(this->min, other.min);
+    this->max = std::max(this->max, other.max);
+}
+
+void LatencyHistogram::Reset() {
+    std::fill(this->buckets.begin(), this->buckets.end(), 0);
+    this->count = 0;
+    this->sum = 0;
+    this->min = UINT64_MAX;
+    this->max = 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+    if (this->count == 0) {
+        return 0;
+    }
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(clamped / 100.0 * double(this->count))));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < this->buckets.size(); i++) {
+        seen += this->buckets[i];
+        if (seen >= rank) {
+            // never report outside the observed range
+            return std::clamp(bucketMidpoint(i), Min(), this->max);
+        }
+    }
+    return this->max;
+}
@@ -0,0 +1,178 @@
+#include "LifeEngine.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <BoardHash.h>
+#include <LifeRule.h>
+#include <SimulationScheduler.h>
+#include <Trace.h>
+
+namespace {
+    EngineFrame initialFrame(const BitGrid& grid, uint64_t generation) {
+        DirtyTiles tiles;
+        tiles.Resize(grid.Width(), grid.Height());
+        EngineFrame frame;
+        frame.generation = generation;
+        frame.grid = grid;
+        frame.tileVersions.assign(tiles.TileCount(), 0);
+        frame.hash = BoardHash::Full(grid);
+        return frame;
+    }
+}
+
+LifeEngine::LifeEngine(const BitGrid& initial, uint64_t generation, double generationsPerSecond, unsigned maxCatchUp,
+    std::function<bool(uint64_t, bool)> wantsSnapshot)
+    : published(initialFrame(initial, generation)), edits(EDIT_QUEUE_SIZE), snapshots(SNAPSHOT_QUEUE_SIZE),
+      wantsSnapshot(std::move(wantsSnapshot)), maxCatchUp(maxCatchUp), rate(generationsPerSecond),
+      latestHash(this->published.LastPublished().hash) {
+    this->changedTiles.Resize(initial.Width(), initial.Height());
+    this->tileVersions.assign(this->changedTiles.TileCount(), 0);
+}
+
+LifeEngine::~LifeEngine() {
+    Stop();
+}
+
+void LifeEngine::Start() {
+    if (this->running.exchange(true)) {
+        return;
+    }
+    this->thread = std::thread(&LifeEngine::simulationLoop, this);
+}
+
+void LifeEngine::Stop() {
+    this->running.store(false);
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+}
+
+void LifeEngine::simulationLoop() {
+    Trace::SetThreadName("simulation");
+    using clock = std::chrono::steady_clock;
+    // longest sleep between checks for edits and commands from the render thread
+    const double maxWait = 0.005;
+
+    const auto start = clock::now();
+    const bool grows = this->growth.Enabled() && this->boundary == Boundary::Dead;
+    double appliedRate = this->rate.load(std::memory_order_relaxed);
+    SimulationScheduler scheduler(appliedRate, this->maxCatchUp);
+    if (this->onStats) {
+        this->onStats(this->published.LastPublished().generation, BoardStats::Of(this->published.LastPublished().grid));
+    }
+
+    while (this->running.load(std::memory_order_relaxed)) {
+        applyEdits();
+
+        const double now = std::chrono::duration<double>(clock::now() - start).count();
+        const double rate = this->rate.load(std::memory_order_relaxed);
+        if (rate != appliedRate) {
+            scheduler.SetRate(rate, now);
+            appliedRate = rate;
+        }
+        // a board that settled into a cycle has nothing new to show
+        const bool settled = this->stopOnCycle && this->cycles.Found();
+        scheduler.SetPaused(this->paused.load(std::memory_order_relaxed) || settled, now);
+        uint32_t singleSteps = this->singleSteps.load(std::memory_order_relaxed);
+        if (singleSteps > 0 && this->singleSteps.compare_exchange_strong(singleSteps, singleSteps - 1)) {
+            scheduler.RequestSingleStep();
+        }
+
+        const unsigned steps = scheduler.StepsDue(now);
+        for (unsigned i = 0; i < steps; i++) {
+            {
+                TRACE_ZONE("LifeEngine::step");
+                const EngineFrame& current = this->published.LastPublished();
+                EngineFrame& next = this->published.WriteBuffer();
+                next.hash = current.hash;
+                next.generation = current.generation + 1;
+                // growth needs the bounding box, which the stats step gets on the way
+                if (this->onStats || grows) {
+                    BoardStats stats;
+                    LifeRule::Step(current.grid, next.grid, this->changedTiles, next.hash, stats, this->boundary);
+                    if (grows && this->growth.Fit(next.grid, stats)) {
+                        resized(next);
+                    }
+                    if (this->onStats) {
+                        this->onStats(next.generation, stats);
+                    }
+                }
+                else {
+                    LifeRule::Step(current.grid, next.grid, this->changedTiles, next.hash, this->boundary);
+                }
+                next.period = current.period;
+                next.originX = this->growth.OriginX();
+                next.originY = this->growth.OriginY();
+                if (this->detectCycles && this->cycles.Observe(next.generation, next.hash, next.grid)) {
+                    next.period = this->cycles.Period();
+                }
+            }
+            publish(true);
+        }
+        this->skippedSteps.store(scheduler.SkippedSteps(), std::memory_order_relaxed);
+
+        if (steps == 0) {
+            const double wait = scheduler.TimeUntilNextStep(now);
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait < 0.0 ? maxWait : std::min(wait, maxWait)));
+        }
+    }
+}
+
+void LifeEngine::applyEdits() {
+    CellEdit edit;
+    if (!this->edits.TryPop(edit)) {
+        return;
+    }
+    TRACE_ZONE("LifeEngine::applyEdits");
+    EngineFrame& next = this->published.WriteBuffer();
+    next.generation = this->published.LastPublished().generation;
+    next.grid = this->published.LastPublished().grid;
+    next.hash = this->published.LastPublished().hash;
+    next.originX = this->published.LastPublished().originX;
+    next.originY = this->published.LastPublished().originY;
+    this->changedTiles.Clear();
+    do {
+        if (edit.x < next.grid.Width() && edit.y < next.grid.Height()) {
+            const size_t index = size_t(edit.y) * next.grid.WordsPerRow() + edit.x / 64;
+            const uint64_t before = next.grid.Words()[index];
+            next.grid.Set(edit.x, edit.y, edit.alive);
+            next.hash = BoardHash::Replace(next.hash, index, before, next.grid.Words()[index]);
+            this->changedTiles.MarkCell(edit.x, edit.y);
+        }
+    } while (this->edits.TryPop(edit));
+    // an edited board starts a new history
+    next.period = 0;
+    this->cycles.Reset();
+    // same generation number; the consumers replace what they have for it
+    publish(true, true);
+}
+
+void LifeEngine::resized(EngineFrame& next) {
+    // every word moved, so the hash starts over and every tile counts as changed
+    next.hash = BoardHash::Full(next.grid);
+    this->changedTiles.Resize(next.grid.Width(), next.grid.Height());
+    this->tileVersions.assign(this->changedTiles.TileCount(), this->sequence + 1);
+    this->cycles.Reset();
+}
+
+void LifeEngine::publish(bool offerSnapshot, bool edited) {
+    EngineFrame& next = this->published.WriteBuffer();
+    this->sequence++;
+    for (uint32_t tile : this->changedTiles.Marked()) {
+        this->tileVersions[tile] = this->sequence;
+    }
+    next.sequence = this->sequence;
+    next.tileVersions = this->tileVersions;
+
+    if (offerSnapshot && this->wantsSnapshot && this->wantsSnapshot(next.generation, edited)) {
+        if (!this->snapshots.TryPush(std::make_shared<const GridSnapshot>(GridSnapshot{ next.generation, next.grid, edited }))) {
+            this->droppedSnapshots.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    this->published.Publish();
+    this->latestHash.store(next.hash, std::memory_order_release);
+    if (this->onPublish) {
+        this->onPublish();
+    }
+}
@@ -0,0 +1,304 @@
+#include "LifeRule.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include <BoardHash.h>
+
+namespace {
+    // Rows are padded with one word on each side, so word i of the row lives at index i + 1
+    // and the neighbours of its edge cells come from the padding instead of a branch.
+    inline void stepRow(const uint64_t* above, const uint64_t* row, const uint64_t* below, uint64_t* out, size_t words) {
+        for (size_t i = 1; i <= words; i++) {
+            const uint64_t nw = (above[i] << 1) | (above[i - 1] >> 63);
+            const uint64_t n = above[i];
+            const uint64_t ne = (above[i] >> 1) | (above[i + 1] << 63);
+            const uint64_t w = (row[i] << 1) | (row[i - 1] >> 63);
+            const uint64_t c = row[i];
+            const uint64_t e = (row[i] >> 1) | (row[i + 1] << 63);
+            const uint64_t sw = (below[i] << 1) | (below[i - 1] >> 63);
+            const uint64_t s = below[i];
+            const uint64_t se = (below[i] >> 1) | (below[i + 1] << 63);
+            out[i - 1] = LifeRule::NextWord(nw, n, ne, w, c, e, sw, s, se);
+        }
+    }
+
+    // Boundary policies. Load puts row y (from -1 to height) of grid into a padded row: the cells
+    // at index 1.., the cell left of the board in the top bit of word 0 and the cell right of it
+    // just past the last cell. Only rows and halos are loaded differently, so the stepping loop
+    // itself is the same for every boundary.
+    inline uint64_t paddedCell(const uint64_t* padded, size_t x) {
+        return (padded[1 + x / 64] >> (x % 64)) & 1;
+    }
+
+    inline void setHalo(uint64_t* padded, size_t width, size_t words, uint64_t left, uint64_t right) {
+        padded[0] = left << 63;
+        padded[words + 1] = 0;
+        padded[1 + width / 64] |= right << (width % 64);
+    }
+
+    // the padding stays zero; only rows inside the ring are stepped
+    struct DeadEdges {
+        static const bool DEAD_RING = true;
+        static const size_t MIN_SIZE = 3;
+
+        static void Load(const BitGrid& grid, ptrdiff_t y, uint64_t* padded) {
+            std::memcpy(padded + 1, grid.Row(size_t(y)), grid.WordsPerRow() * sizeof(uint64_t));
+        }
+    };
+
+    struct TorusEdges {
+        static const bool DEAD_RING = false;
+        static const size_t MIN_SIZE = 1;
+
+        static void Load(const BitGrid& grid, ptrdiff_t y, uint64_t* padded) {
+            const size_t width = grid.Width(), height = grid.Height(), words = grid.WordsPerRow();
+            const size_t row = y < 0 ? height - 1 : size_t(y) == height ? 0 : size_t(y);
+            std::memcpy(padded + 1, grid.Row(row), words * sizeof(uint64_t));
+            setHalo(padded, width, words, paddedCell(padded, width - 1), paddedCell(padded, 0));
+        }
+    };
+
+    struct KleinEdges {
+        static const bool DEAD_RING = false;
+        static const size_t MIN_SIZE = 1;
+
+        static void Load(const BitGrid& grid, ptrdiff_t y, uint64_t* padded) {
+            const size_t width = grid.Width(), height = grid.Height(), words = grid.WordsPerRow();
+            const size_t row = y < 0 ? height - 1 : size_t(y) == height ? 0 : size_t(y);
+            std::memcpy(padded + 1, grid.Row(row), words * sizeof(uint64_t));
+            if (row != size_t(y)) {
+                // across the top or bottom edge x runs the other way; two rows per step, so bit by bit
+                for (size_t x = 0; x < width / 2; x++) {
+                    const uint64_t swapped = paddedCell(padded, x) ^ paddedCell(padded, width - 1 - x);
+                    padded[1 + x / 64] ^= swapped << (x % 64);
+                    padded[1 + (width - 1 - x) / 64] ^= swapped << ((width - 1 - x) % 64);
+                }
+            }
+            setHalo(padded, width, words, paddedCell(padded, width - 1), paddedCell(padded, 0));
+        }
+    };
+
+    struct MirrorEdges {
+        static const bool DEAD_RING = false;
+        static const size_t MIN_SIZE = 1;
+
+        static void Load(const BitGrid& grid, ptrdiff_t y, uint64_t* padded) {
+            const size_t width = grid.Width(), height = grid.Height(), words = grid.WordsPerRow();
+            const size_t row = size_t(std::clamp<ptrdiff_t>(y, 0, ptrdiff_t(height) - 1));
+            std::memcpy(padded + 1, grid.Row(row), words * sizeof(uint64_t));
+            setHalo(padded, width, words, paddedCell(padded, 0), paddedCell(padded, width - 1));
+        }
+    };
+
+    // marks the tiles of a band of rows whose accumulated changes are non-zero, then resets them
+    inline void flushChanges(uint64_t* changes, size_t words, size_t tileY, DirtyTiles& changed) {
+        for (size_t i = 0; i < words; i++) {
+            if (changes[i]) {
+                changed.Mark(i, tileY);
+                changes[i] = 0;
+            }
+        }
+    }
+
+    template <class Edges, bool TrackChanges, bool TrackHash, bool TrackStats>
+    void step(const BitGrid& current, BitGrid& next, DirtyTiles* changed, uint64_t* hash, BoardStats* stats) {
+        const size_t width = current.Width();
+        const size_t height = current.Height();
+        const size_t words = current.WordsPerRow();
+        if (next.Width() != width || next.Height() != height) {
+            next.Resize(width, height);
+        }
+        if constexpr (TrackChanges) {
+            if (changed->TilesX() != (width + DirtyTiles::TILE_SIZE - 1) / DirtyTiles::TILE_SIZE ||
+                changed->TilesY() != (height + DirtyTiles::TILE_SIZE - 1) / DirtyTiles::TILE_SIZE) {
+                changed->Resize(width, height);
+            }
+            changed->Clear();
+        }
+        if (width < Edges::MIN_SIZE || height < Edges::MIN_SIZE) {
+            // every cell is on the dead boundary ring, or there are none
+            if constexpr (TrackChanges) {
+                for (size_t y = 0; y < height; y++) {
+                    for (size_t i = 0; i < words; i++) {
+                        if (current.Row(y)[i] != 0) {
+                            changed->Mark(i, y / DirtyTiles::TILE_SIZE);
+                        }
+                    }
+                }
+            }
+            if constexpr (TrackHash) {
+                *hash = 0;
+            }
+            if constexpr (TrackStats) {
+                *stats = BoardStats();
+                stats->deaths = current.Population();
+            }
+            next.Clear();
+            return;
+        }
+
+        // three rolling padded rows, halos filled by Edges
+        const size_t stride = words + 2;
+        thread_local std::vector<uint64_t> scratch;
+        scratch.assign(3 * stride + (TrackChanges ? words : 0) + (TrackStats ? words : 0), 0);
+        uint64_t* above = scratch.data();
+        uint64_t* row = above + stride;
+        uint64_t* below = row + stride;
+        // flipped bits of the current band of tile rows, OR-ed per word, so the hot loop stays branch free
+        uint64_t* changes = below + stride;
+        // live bits of every column OR-ed over all rows, for the bounding box
+        uint64_t* columns = changes + words;
+
+        // popcounts of the words the change loop already has in registers
+        uint64_t population = 0, births = 0, deaths = 0;
+        size_t firstLiveRow = height, lastLiveRow = 0;
+
+        if constexpr (TrackChanges && Edges::DEAD_RING) {
+            // the outer rows become dead
+            for (size_t i = 0; i < words; i++) {
+                changes[i] = current.Row(0)[i];
+                if constexpr (TrackHash) {
+                    *hash -= BoardHash::Word(i, current.Row(0)[i]);
+                }
+                if constexpr (TrackStats) {
+                    deaths += uint64_t(std::popcount(current.Row(0)[i]));
+                }
+            }
+        }
+
+        // with a dead ring the first and last row are not stepped
+        const size_t firstRow = Edges::DEAD_RING ? 1 : 0;
+        const size_t endRow = Edges::DEAD_RING ? height - 1 : height;
+        Edges::Load(current, ptrdiff_t(firstRow) - 1, above);
+        Edges::Load(current, ptrdiff_t(firstRow), row);
+
+        const uint64_t lastMask = current.LastWordMask();
+        const size_t lastX = width - 1;
+        for (size_t y = firstRow; y < endRow; y++) {
+            Edges::Load(current, ptrdiff_t(y) + 1, below);
+
+            uint64_t* out = next.Row(y);
+            stepRow(above, row, below, out, words);
+            out[words - 1] &= lastMask;
+
+            if constexpr (Edges::DEAD_RING) {
+                // force the left and right edge cells dead
+                out[0] &= ~1ull;
+                out[lastX / 64] &= ~(1ull << (lastX % 64));
+            }
+
+            if constexpr (TrackChanges) {
+                // both rows are still in L1 and the loop is branch free, so this is nearly free;
+                // the row is read from the board since its padded copy may carry a halo bit
+                const uint64_t* was = current.Row(y);
+                uint64_t rowBits = 0;
+                for (size_t i = 0; i < words; i++) {
+                    const uint64_t flipped = out[i] ^ was[i];
+                    changes[i] |= flipped;
+                    if constexpr (TrackHash) {
+                        // only changed words touch the hash, so settled regions cost one predictable branch
+                        if (flipped) {
+                            *hash = BoardHash::Replace(*hash, y * words + i, was[i], out[i]);
+                        }
+                    }
+                    if constexpr (TrackStats) {
+                        population += uint64_t(std::popcount(out[i]));
+                        births += uint64_t(std::popcount(flipped & out[i]));
+                        deaths += uint64_t(std::popcount(flipped & was[i]));
+                        columns[i] |= out[i];
+                        rowBits |= out[i];
+                    }
+                }
+                if constexpr (TrackStats) {
+                    if (rowBits != 0) {
+                        firstLiveRow = std::min(firstLiveRow, y);
+                        lastLiveRow = y;
+                    }
+                }
+                if ((y + 1) % DirtyTiles::TILE_SIZE == 0) {
+                    flushChanges(changes, words, y / DirtyTiles::TILE_SIZE, *changed);
+                }
+            }
+
+            std::swap(above, row);
+            std::swap(row, below);
+        }
+
+        if constexpr (TrackChanges) {
+            if constexpr (Edges::DEAD_RING) {
+                for (size_t i = 0; i < words; i++) {
+                    changes[i] |= current.Row(height - 1)[i];
+                    if constexpr (TrackHash) {
+                        *hash -= BoardHash::Word((height - 1) * words + i, current.Row(height - 1)[i]);
+                    }
+                    if constexpr (TrackStats) {
+                        deaths += uint64_t(std::popcount(current.Row(height - 1)[i]));
+                    }
+                }
+            }
+            flushChanges(changes, words, (height - 1) / DirtyTiles::TILE_SIZE, *changed);
+        }
+        if constexpr (TrackStats) {
+            *stats = BoardStats();
+            stats->population = population;
+            stats->births = births;
+            stats->deaths = deaths;
+            if (population > 0) {
+                size_t first = 0, last = words - 1;
+                while (columns[first] == 0) {
+                    first++;
+                }
+                while (columns[last] == 0) {
+                    last--;
+                }
+                stats->minX = uint32_t(first * 64 + std::countr_zero(columns[first]));
+                stats->maxX = uint32_t(last * 64 + 63 - std::countl_zero(columns[last]));
+                stats->minY = uint32_t(firstLiveRow);
+                stats->maxY = uint32_t(lastLiveRow);
+            }
+        }
+        if constexpr (Edges::DEAD_RING) {
+            std::fill(next.Row(0), next.Row(0) + words, 0);
+            std::fill(next.Row(height - 1), next.Row(height - 1) + words, 0);
+        }
+    }
+
+    // picks the instantiation once per generation, so the loops never look at the boundary
+    template <bool TrackChanges, bool TrackHash, bool TrackStats>
+    void step(Boundary boundary, const BitGrid& current, BitGrid& next, DirtyTiles* changed, uint64_t* hash, BoardStats* stats) {
+        switch (boundary) {
+        case Boundary::Torus:
+            step<TorusEdges, TrackChanges, TrackHash, TrackStats>(current, next, changed, hash, stats);
+            break;
+        case Boundary::Klein:
+            step<KleinEdges, TrackChanges, TrackHash, TrackStats>(current, next, changed, hash, stats);
+            break;
+        case Boundary::Mirror:
+            step<MirrorEdges, TrackChanges, TrackHash, TrackStats>(current, next, changed, hash, stats);
+            break;
+        default:
+            step<DeadEdges, TrackChanges, TrackHash, TrackStats>(current, next, changed, hash, stats);
+            break;
+        }
+    }
+}
+
+void LifeRule::Step(const BitGrid& current, BitGrid& next, Boundary boundary) {
+    step<false, false, false>(boundary, current, next, nullptr, nullptr, nullptr);
+}
+
+void LifeRule::Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, Boundary boundary) {
+    step<true, false, false>(boundary, current, next, &changed, nullptr, nullptr);
+}
+
+void LifeRule::Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, uint64_t& hash, Boundary boundary) {
+    step<true, true, false>(boundary, current, next, &changed, &hash, nullptr);
+}
+
+void LifeRule::Step(const BitGrid& current, BitGrid& next, DirtyTiles& changed, uint64_t& hash, BoardStats& stats, Boundary boundary) {
+    step<true, true, true>(boundary, current, next, &changed, &hash, &stats);
+}
@@ -2,7 +2,9 @@
 #include <GLFW/glfw3.h>
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <vector>
 #include <stb_image.h>
@@ -11,32 +13,133 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <AppConfig.h>
+#include <Benchmark.h>
+#include <Camera.h>
+#include <CheckpointWriter.h>
+#include <DensityPyramid.h>
+#include <GpuBatch.h>
+#include <GpuTimer.h>
+#include <GridSnapshot.h>
+#include <HistoryRecorder.h>
+#include <LifeEngine.h>
+#include <Metrics.h>
+#include <RewindBuffer.h>
 #include <Shader.h>
+#include <SimulationScheduler.h>
 #include <SimulationShader.h>
+#include <SoupSearch.h>
+#include <StatsWriter.h>
+#include <TerminalMode.h>
+#include <TextureUploader.h>
 #include <RandomGenerator.h>
+#include <Trace.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+// everything that consumes read back generations
+struct SnapshotConsumers
+{
+    CheckpointWriter& checkpointWriter;
+    HistoryRecorder* historyRecorder;   // null when not recording
+    RewindBuffer& rewindBuffer;
+
+    bool WantsGeneration(uint64_t generation) const {
+        return checkpointWriter.IsDue(generation) || historyRecorder || rewindBuffer.IsDue(generation);
+    }
+    // an edited board has to reach the recording and the rewind buffer, whatever its generation
+    bool WantsEdits() const {
+        return historyRecorder || rewindBuffer.Enabled();
+    }
+};
+
+double RequestSnapshot(SimulationShader& simulationShader, SnapshotConsumers& consumers, uint64_t generation, bool edited = false);
+double CollectSnapshots(SimulationShader& simulationShader, SnapshotConsumers& consumers, bool wait = false);
+double CollectEngineSnapshots(LifeEngine& engine, SnapshotConsumers& consumers);
+void DeliverSnapshot(SnapshotConsumers& consumers, const GridSnapshotPtr& snapshot);
+void RequestStats(SimulationShader& simulationShader, StatsWriter& statsWriter, uint64_t generation);
+void CollectStats(SimulationShader& simulationShader, StatsWriter& statsWriter, bool wait);
+void CollectMouseEdits(GLFWwindow* window, unsigned int boardWidth, unsigned int boardHeight, std::vector<CellEdit>& edits);
 void CreateRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO);
-void DeleteRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO, GLuint& renderTexture);
+GLuint CreateAgePalette();
+void DeleteRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO);
 
 // settings
 const unsigned int SCR_WIDTH = 1024;
 const unsigned int SCR_HEIGHT = 1024;
 
-const unsigned int TEX_WIDTH = 256;
-const unsigned int TEX_HEIGHT = 256;
-
 // time
 float deltaTime = 0.0f;
 float lastFrameTime = 0.0f;
 
-// camera
+// camera: scroll zooms at the cursor, middle mouse drags, Home shows the whole board
+Camera camera;
+glm::vec2 boardSize;
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 
-int main()
+// rewind: generations to scrub by this frame (negative = backwards)
+int scrubSteps = 0;
+
+// pacing: space toggles pause, N runs a single generation
+bool userPaused = false;
+int singleStepRequests = 0;
+
+// the loop only redraws when something changed and otherwise waits for events;
+// inputHeld keeps it polling while held keys/buttons act without producing new events
+bool redrawRequested = true;
+bool inputHeld = false;
+
+// tracing: F9 toggles recording, F10 writes the trace
+bool traceDumpRequested = false;
+
+int main(int argc, char** argv)
 {
+    AppConfig config;
+    try {
+        config = ParseCommandLine(argc, argv);
+    }
+    catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+        PrintUsage();
+        return -1;
+    }
+    if (config.showHelp) {
+        PrintUsage();
+        return 0;
+    }
+    if (config.gpuBatchBoards > 0) {
+        return RunGpuBatch(config);
+    }
+    if (config.benchmarkGenerations > 0) {
+        return RunBenchmark(config);
+    }
+    if (config.soupCount > 0) {
+        return RunSoupSearch(config);
+    }
+    if (config.terminal) {
+        return RunTerminal(config);
+    }
+
+    Trace::SetThreadName("render");
+    Trace::SetEnabled(!config.tracePath.empty());
+
+    // a replay opens on the recorded board, at the size it was recorded with
+    const bool replaying = !config.replayPath.empty();
+    HistoryRecorder replayHistory(config.keyframeInterval);
+    GridSnapshot replayLast;
+    if (replaying) {
+        if (!replayHistory.Load(config.replayPath) || !replayHistory.Seek(replayHistory.LastGeneration(), replayLast)) {
+            std::cout << "Nothing to replay in " << config.replayPath << std::endl;
+            return -1;
+        }
+        config.boardWidth = unsigned(replayLast.grid.Width());
+        config.boardHeight = unsigned(replayLast.grid.Height());
+    }
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -59,6 +162,9 @@ int main()
     }
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
     //glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     // glad: load all OpenGL function pointers
@@ -70,79 +176,481 @@ int main()
     }
 
     // Create GL objects
-    GLuint VAO, VBO, EBO, renderTexture;
+    GLuint VAO, VBO, EBO;
     // setup verts/indicies/ebo
     CreateRenderQuad(VAO, VBO, EBO);
 
     Shader renderShader = Shader();
     renderShader.use();
-    renderShader.setIVec2("gridSize", glm::uvec2(TEX_WIDTH, TEX_HEIGHT));
+    renderShader.setIVec2("gridSize", glm::uvec2(config.boardWidth, config.boardHeight));
     renderShader.setInt("currentState", 0); // use texture unit 0 as the current state
 
     // Setup simulation shader program
-    SimulationShader simulationShader("src/shaders/shader.vert", "src/shaders/simulation.frag");
-    simulationShader.Initialize(TEX_WIDTH, TEX_HEIGHT);
+    // the age plane costs an extra texture read and write per cell, so it is only kept when shown
+    const bool trackAge = config.ageColors && config.engine == SimulationEngine::Gpu;
+    SimulationShader simulationShader("src/shaders/shader.vert", "src/shaders/simulation.frag", trackAge, config.boundary);
+    simulationShader.Initialize(config.boardWidth, config.boardHeight, config.gpuTileSize);
+
+    // Generate a random grid, or continue from a checkpoint
+    uint64_t generation = 0;
+    BitGrid grid(config.boardWidth, config.boardHeight);
+    if (replaying) {
+        if (!config.resumeFrom.empty()) {
+            std::cout << "Replaying " << config.replayPath << ", ignoring --resume" << std::endl;
+        }
+        grid = std::move(replayLast.grid);
+        generation = replayLast.generation;
+    }
+    else if (!config.resumeFrom.empty()) {
+        GridSnapshot checkpoint;
+        if (!CheckpointWriter::Load(config.resumeFrom, checkpoint)) {
+            glfwTerminate();
+            return -1;
+        }
+        if (checkpoint.grid.Width() != config.boardWidth || checkpoint.grid.Height() != config.boardHeight) {
+            std::cout << "Checkpoint is " << checkpoint.grid.Width() << "x" << checkpoint.grid.Height()
+                << ", expected " << config.boardWidth << "x" << config.boardHeight << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        grid = std::move(checkpoint.grid);
+        generation = checkpoint.generation;
+    }
+    else {
+        RandomGenerator rng = config.seed ? RandomGenerator(config.seed) : RandomGenerator();
+        rng.fillGridWithNoise(grid);
+    }
+    // New apply to grid
+    simulationShader.ProvideInitialGrid(grid);
 
-    // Create render texture
-    glGenTextures(1, &renderTexture);
-    glBindTexture(GL_TEXTURE_2D, renderTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, TEX_WIDTH, TEX_HEIGHT, 0, GL_RED, GL_FLOAT, nullptr);
+    CheckpointWriter checkpointWriter(config.checkpointDirectory, config.checkpointInterval, config.checkpointMaxPending);
+
+    // history recording reads back every generation and streams it to the file as it goes
+    const bool recording = !config.recordPath.empty();
+    std::unique_ptr<HistoryRecorder> historyRecorder;
+    if (recording) {
+        historyRecorder = std::make_unique<HistoryRecorder>(config.keyframeInterval, config.recordPath);
+    }
+
+    RewindBuffer rewindBuffer(config.rewindInterval, config.rewindMemoryMiB * 1024 * 1024, config.boundary);
+
+    SnapshotConsumers consumers{ checkpointWriter, historyRecorder.get(), rewindBuffer };
+
+    // outlives the engine, whose simulation thread writes to it
+    std::unique_ptr<StatsWriter> statsWriter;
+    if (!config.statsPath.empty()) {
+        statsWriter = std::make_unique<StatsWriter>(config.statsPath);
+    }
+
+    // the CPU engine steps on its own thread; without it the shader steps on this one
+    std::unique_ptr<LifeEngine> engine;
+    if (config.engine == SimulationEngine::Cpu) {
+        if (consumers.WantsGeneration(generation)) {
+            DeliverSnapshot(consumers, std::make_shared<const GridSnapshot>(GridSnapshot{ generation, grid }));
+        }
+        engine = std::make_unique<LifeEngine>(grid, generation, config.generationsPerSecond, config.maxCatchUp,
+            [&consumers](uint64_t snapshotGeneration, bool edited) { return edited ? consumers.WantsEdits() : consumers.WantsGeneration(snapshotGeneration); });
+        // wake the render loop when a new generation is ready
+        engine->SetPublishCallback([]() { glfwPostEmptyEvent(); });
+        engine->SetBoundary(config.boundary);
+        if (config.growBoard && config.boundary != Boundary::Dead) {
+            std::cout << "A growing board needs --boundary dead, ignoring --grow" << std::endl;
+        }
+        else if (config.growBoard) {
+            engine->SetGrowth(BoardGrowth(config.shrinkBoard));
+        }
+        if (config.cycleAction != CycleAction::Off) {
+            engine->DetectCycles(config.cycleAction != CycleAction::Report);
+        }
+        if (statsWriter) {
+            engine->CollectStats([&statsWriter](uint64_t statsGeneration, const BoardStats& stats) { statsWriter->Write(statsGeneration, stats); });
+        }
+        engine->Start();
+    }
+    else {
+        if (config.cycleAction != CycleAction::Off) {
+            std::cout << "Cycle detection needs --engine cpu, ignoring --on-cycle" << std::endl;
+        }
+        if (config.growBoard) {
+            std::cout << "A growing board needs --engine cpu, ignoring --grow" << std::endl;
+        }
+        RequestSnapshot(simulationShader, consumers, generation);
+        if (statsWriter) {
+            // the shader's reduction compares against the previous generation, which does not exist yet
+            statsWriter->Write(generation, BoardStats::Of(grid));
+        }
+    }
+    std::vector<CellEdit> cellEdits;
+    // the CPU engine and rewound boards display through a bit-packed texture; the engine
+    // only sends the tiles it changed. The GPU engine draws straight from its tiles.
+    TextureUploader textureUploader(config.fullUploadFraction);
+    GLuint packedTexture = 0;
+    glGenTextures(1, &packedTexture);
+    glBindTexture(GL_TEXTURE_2D, packedTexture);
+    // integer textures are incomplete with linear filtering
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (engine) {
+        textureUploader.Upload(engine->Latest(), packedTexture);
+    }
+    // both engines own a copy of the board by now
+    grid = BitGrid();
+    renderShader.use();
+    renderShader.setInt("packedState", 1);
+    // packed boards keep their own density pyramid, updated from the tiles that changed
+    DensityPyramid densityPyramid;
+    renderShader.setInt("densityPyramid", 2);
+    renderShader.setInt("ageState", 3);
+    renderShader.setInt("agePalette", 4);
+    const GLuint agePalette = trackAge ? CreateAgePalette() : 0;
+
+    boardSize = glm::vec2(config.boardWidth, config.boardHeight);
+    // where the CPU engine's board currently starts on the starting board, see BoardGrowth
+    glm::ivec2 boardOrigin(0);
+    {
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        camera.Fit(boardSize, glm::vec2(windowWidth, windowHeight));
+    }
 
-    // Generate a random grid
-    std::vector<float> grid(TEX_WIDTH * TEX_HEIGHT);
-    RandomGenerator rng = RandomGenerator();
-    rng.fillGridWithNoise(grid);
-    // New apply to grid
-    simulationShader.ProvideInitialGrid(grid);
-
+    // period last reported by the CPU engine's cycle detection
+    uint64_t reportedPeriod = 0;
+
+    // while scrubbing the simulation is paused and viewGeneration is shown instead
+    bool scrubbing = false;
+    uint64_t viewGeneration = generation;
+    // the rewound board on screen, kept for the density pyramid
+    GridSnapshot rewound;
+    GridSnapshot rewindResult;
+    bool rewoundReady = false;
+    bool rewoundCounted = false;
+    // viewGeneration is to be decoded from the replayed recording rather than the rewind buffer
+    bool replaySeek = false;
+    if (replaying) {
+        userPaused = true;
+        viewGeneration = replayHistory.FirstGeneration();
+        scrubbing = replaySeek = viewGeneration < generation;
+        glfwSetWindowTitle(window, ("LearnOpenGL - rewound to generation " + std::to_string(viewGeneration) + " / " + std::to_string(generation)).c_str());
+    }
 
-    // set timer for re-rendering to 0 to immediately render 
-    float drawTimeRemaining = 0;
+    // latency histograms, reported every --metrics-interval seconds and at shutdown
+    Metrics metrics(config.metricsInterval);
+    const size_t frameMetric = metrics.Register("frame");
+    const size_t stepMetric = metrics.Register("simulation step");
+    const size_t presentMetric = metrics.Register("present");
+    const size_t snapshotMetric = metrics.Register("snapshot capture");
+    const size_t uploadMetric = metrics.Register("texture upload");
+
+    // CPU timings above only cover command submission; these measure the passes on the GPU
+    GpuTimer gpuTimer(metrics);
+    const size_t simulatePass = gpuTimer.AddPass("simulate");
+    const size_t drawPass = gpuTimer.AddPass("draw");
+
+    // paces the GPU engine; the CPU engine runs its own on the simulation thread
+    SimulationScheduler scheduler(config.generationsPerSecond, config.maxCatchUp);
+    // longest time the loop sleeps without events, and the wait while something needs polling
+    const double IDLE_WAIT = 0.25;
+    const double POLL_WAIT = 1.0 / 120.0;
+    lastFrameTime = glfwGetTime();
 
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
     {
+        TRACE_ZONE("frame");
+
         // handle time
-        float currentFrameTime = glfwGetTime();
+        const double currentFrameTime = glfwGetTime();
         deltaTime = currentFrameTime - lastFrameTime;
         lastFrameTime = currentFrameTime;
-        drawTimeRemaining -= deltaTime;
 
-        printf("FPS: %d\r", int(1.0f / deltaTime));
+        gpuTimer.Collect();
+        metrics.MaybeReport(currentFrameTime);
 
         // input
         // -----
-        processInput(window);
+        {
+            TRACE_ZONE("input");
+            processInput(window);
+            CollectMouseEdits(window, unsigned(boardSize.x), unsigned(boardSize.y), cellEdits);
+        }
+        if (!cellEdits.empty() && !scrubbing) {
+            for (const CellEdit& edit : cellEdits) {
+                if (engine) {
+                    engine->PushEdit(edit);
+                }
+                else {
+                    simulationShader.SetCell(edit.x, edit.y, edit.alive);
+                }
+            }
+            if (!engine) {
+                redrawRequested = true;
+                // the engine offers its edited board itself
+                RequestSnapshot(simulationShader, consumers, generation, true);
+            }
+        }
+        cellEdits.clear();
+        if (traceDumpRequested) {
+            Trace::WriteChromeJson(config.tracePath.empty() ? "trace.json" : config.tracePath);
+            traceDumpRequested = false;
+        }
 
-        if (drawTimeRemaining <= 0) {
-            //std::cout << "Rendering new generation" << std::endl;
+        if (scrubSteps != 0 && (rewindBuffer.Enabled() || replaying)) {
+            if (!scrubbing) {
+                viewGeneration = generation;
+            }
+            const int64_t oldest = int64_t(replaying ? replayHistory.FirstGeneration() : rewindBuffer.OldestGeneration());
+            viewGeneration = uint64_t(std::clamp(int64_t(viewGeneration) + scrubSteps, oldest, int64_t(generation)));
+            scrubbing = viewGeneration < generation;
+            redrawRequested = true;
+            // the rewind buffer only holds what ran after the recording was opened
+            replaySeek = scrubbing && replaying && (viewGeneration <= replayHistory.LastGeneration() ||
+                !rewindBuffer.Enabled() || viewGeneration < rewindBuffer.OldestGeneration());
+            if (scrubbing) {
+                if (!replaySeek) {
+                    rewindBuffer.Request(viewGeneration);
+                }
+                glfwSetWindowTitle(window, ("LearnOpenGL - rewound to generation " + std::to_string(viewGeneration) + " / " + std::to_string(generation)).c_str());
+            }
+            else {
+                // back at the live generation
+                if (engine) {
+                    textureUploader.Upload(engine->Latest(), packedTexture);
+                }
+                rewoundReady = false;
+                glfwSetWindowTitle(window, "LearnOpenGL");
+            }
+        }
+        scrubSteps = 0;
 
-            simulationShader.RunSimulation();
-            //simulationShader.DebugSimulationTexture();
-            simulationShader.CopySimulationResultsToTexture(renderTexture);
-            drawTimeRemaining = .1f;
+        // single steps only apply to the live board
+        const bool paused = userPaused || scrubbing;
+        if (scrubbing) {
+            singleStepRequests = 0;
+        }
+        if (engine) {
+            engine->SetPaused(paused);
+            for (; singleStepRequests > 0; singleStepRequests--) {
+                engine->RequestSingleStep();
+            }
+        }
+        else {
+            scheduler.SetPaused(paused, currentFrameTime);
+            if (singleStepRequests > 0) {
+                scheduler.RequestSingleStep();
+                singleStepRequests = 0;
+            }
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
-        glClear(GL_COLOR_BUFFER_BIT);
-        renderShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, renderTexture);
+        if (scrubbing) {
+            // recorded frames decode right away from their keyframe; the rewind worker answers
+            // later, and an answer to a request that was since replaced is dropped
+            bool arrived = false;
+            if (replaySeek) {
+                arrived = replayHistory.Seek(viewGeneration, rewound);
+                replaySeek = false;
+            }
+            else if (rewindBuffer.TakeResult(rewindResult) && rewindResult.generation == viewGeneration) {
+                std::swap(rewound, rewindResult);
+                arrived = true;
+            }
+            if (arrived) {
+                textureUploader.UploadGrid(rewound.grid, packedTexture);
+                rewoundReady = true;
+                rewoundCounted = false;
+                redrawRequested = true;
+            }
+        }
+        else if (engine) {
+            // never waits: shows whatever the simulation thread finished last
+            if (engine->TakeLatest()) {
+                const double uploadStart = glfwGetTime();
+                generation = engine->Latest().generation;
+                textureUploader.Upload(engine->Latest(), packedTexture);
+                metrics.RecordSeconds(uploadMetric, glfwGetTime() - uploadStart);
+                redrawRequested = true;
+
+                // a growing board moved its cells; keep the view on the same ones
+                const EngineFrame& latest = engine->Latest();
+                const glm::ivec2 origin(int(latest.originX), int(latest.originY));
+                if (origin != boardOrigin) {
+                    camera.Translate(glm::vec2(boardOrigin - origin));
+                    boardOrigin = origin;
+                }
+                boardSize = glm::vec2(latest.grid.Width(), latest.grid.Height());
+
+                // edits clear the period, so a board can settle more than once
+                const uint64_t period = engine->Latest().period;
+                if (period != reportedPeriod && period > 0) {
+                    std::cout << "Board repeats with period " << period << " at generation " << generation << std::endl;
+                }
+                reportedPeriod = period;
+            }
+        }
+        else {
+            const unsigned steps = scheduler.StepsDue(glfwGetTime());
+            for (unsigned i = 0; i < steps; i++) {
+                {
+                    TRACE_ZONE("simulate");
+                    const double stepStart = glfwGetTime();
+                    gpuTimer.Begin(simulatePass);
+                    simulationShader.RunSimulation();
+                    gpuTimer.End(simulatePass);
+                    metrics.RecordSeconds(stepMetric, glfwGetTime() - stepStart);
+                    generation++;
+                }
+                if (statsWriter) {
+                    RequestStats(simulationShader, *statsWriter, generation);
+                }
+                const double requestSeconds = RequestSnapshot(simulationShader, consumers, generation);
+                if (requestSeconds > 0.0) {
+                    metrics.RecordSeconds(snapshotMetric, requestSeconds);
+                }
+            }
+            if (steps > 0) {
+                redrawRequested = true;
+            }
+        }
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        const double collectSeconds = engine ? CollectEngineSnapshots(*engine, consumers) : CollectSnapshots(simulationShader, consumers);
+        if (statsWriter && !engine) {
+            CollectStats(simulationShader, *statsWriter, false);
+        }
+        if (collectSeconds > 0.0) {
+            metrics.RecordSeconds(snapshotMetric, collectSeconds);
+        }
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if (redrawRequested) {
+            TRACE_ZONE("draw");
+            gpuTimer.Begin(drawPass);
+            int framebufferWidth, framebufferHeight, windowWidth, windowHeight;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            glfwGetWindowSize(window, &windowWidth, &windowHeight);
+            const glm::vec2 viewport(windowWidth, windowHeight);
+
+            // the GPU engine shows its live tiles, everything else the packed texture
+            const bool showPacked = engine || (scrubbing && rewoundReady);
+            // the heatmap is only sampled once a pixel covers more than one cell
+            const bool zoomedOut = camera.CellsPerPixel() > 1.0f;
+            if (zoomedOut && showPacked) {
+                if (!scrubbing) {
+                    densityPyramid.Update(engine->Latest());
+                }
+                else if (rewoundReady && !rewoundCounted) {
+                    densityPyramid.Rebuild(rewound.grid);
+                    rewoundCounted = true;
+                }
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, framebufferWidth, framebufferHeight);
+            glClear(GL_COLOR_BUFFER_BIT);
+            renderShader.use();
+            renderShader.setVec2("viewOrigin", camera.ViewOrigin(viewport));
+            renderShader.setVec2("viewSize", camera.ViewSize(viewport));
+            renderShader.setFloat("cellsPerPixel", camera.CellsPerPixel());
+            // a rewound board may be from before the board last grew
+            renderShader.setIVec2("gridSize", scrubbing && rewoundReady ? glm::ivec2(rewound.grid.Width(), rewound.grid.Height()) : glm::ivec2(boardSize));
+            renderShader.setBool("usePackedState", showPacked);
+            renderShader.setBool("useDensityPyramid", showPacked);
+            // packed boards carry no ages
+            renderShader.setBool("useAgePalette", trackAge && !showPacked);
+            if (showPacked) {
+                renderShader.setIVec2("tileOrigin", glm::ivec2(0));
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, packedTexture);
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, densityPyramid.Texture());
+                glActiveTexture(GL_TEXTURE0);
+
+                glBindVertexArray(VAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            }
+            else {
+                glActiveTexture(GL_TEXTURE4);
+                glBindTexture(GL_TEXTURE_2D, agePalette);
+                glActiveTexture(GL_TEXTURE0);
+                // only the tiles inside the window are drawn
+                simulationShader.Draw(renderShader, camera.ViewOrigin(viewport), camera.ViewSize(viewport),
+                    glm::ivec2(framebufferWidth, framebufferHeight), zoomedOut);
+            }
+            gpuTimer.End(drawPass);
+
+            // glfw: swap buffers
+            // ------------------
+            {
+                TRACE_ZONE("swap");
+                const double presentStart = glfwGetTime();
+                glfwSwapBuffers(window);
+                metrics.RecordSeconds(presentMetric, glfwGetTime() - presentStart);
+            }
+            // time to produce a frame, not counting the idle wait below
+            metrics.RecordSeconds(frameMetric, glfwGetTime() - currentFrameTime);
+            redrawRequested = false;
+        }
+
+        // glfw: wait for IO events (keys pressed/released, mouse moved etc.) or the next
+        // generation instead of spinning; poll while something is still in flight
+        // ------------------------------------------------------------------------------
+        {
+            TRACE_ZONE("wait");
+            double wait = engine ? IDLE_WAIT : scheduler.TimeUntilNextStep(glfwGetTime());
+            if (wait < 0.0 || wait > IDLE_WAIT) {
+                wait = IDLE_WAIT;
+            }
+            if (inputHeld || scrubbing || (!engine && simulationShader.HasPendingReadbacks())) {
+                wait = std::min(wait, POLL_WAIT);
+            }
+            if (wait > 0.0) {
+                glfwWaitEventsTimeout(wait);
+            }
+            else {
+                glfwPollEvents();
+            }
+        }
     }
 
-    DeleteRenderQuad(VAO, VBO, EBO, renderTexture);
+    DeleteRenderQuad(VAO, VBO, EBO);
+    glDeleteTextures(1, &packedTexture);
+    glDeleteTextures(1, &agePalette);
+
+    if (engine) {
+        engine->Stop();
+        CollectEngineSnapshots(*engine, consumers);
+        if (engine->DroppedSnapshots() > 0) {
+            std::cout << "Snapshots dropped by the simulation thread: " << engine->DroppedSnapshots() << std::endl;
+        }
+        textureUploader.PrintStats();
+    }
+    if (statsWriter) {
+        if (!engine) {
+            CollectStats(simulationShader, *statsWriter, true);
+        }
+        std::cout << "Stats: " << statsWriter->Records() << " generations written to " << config.statsPath << std::endl;
+    }
+    const uint64_t skippedSteps = engine ? engine->SkippedSteps() : scheduler.SkippedSteps();
+    if (skippedSteps > 0) {
+        std::cout << "Late generations dropped by the scheduler: " << skippedSteps << std::endl;
+    }
+    if (recording) {
+        if (!engine) {
+            CollectSnapshots(simulationShader, consumers, true);
+        }
+        historyRecorder->PrintStats();
+        // flushes the frames since the last keyframe
+        historyRecorder.reset();
+    }
+    metrics.PrintSummary();
+    if (gpuTimer.Dropped() > 0) {
+        std::cout << "GPU timer samples dropped: " << gpuTimer.Dropped() << std::endl;
+    }
+    if (checkpointWriter.Enabled()) {
+        checkpointWriter.PrintStats();
+    }
+    if (!config.tracePath.empty()) {
+        Trace::WriteChromeJson(config.tracePath);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -156,6 +664,218 @@ void processInput(GLFWwindow* window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+
+    // F9 toggles trace recording, F10 writes what has been recorded so far
+    static bool tracingKeysDown[2] = { false, false };
+    const bool toggleDown = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+    const bool dumpDown = glfwGetKey(window, GLFW_KEY_F10) == GLFW_PRESS;
+    if (toggleDown && !tracingKeysDown[0]) {
+        Trace::SetEnabled(!Trace::Enabled());
+        std::cout << "Tracing " << (Trace::Enabled() ? "enabled" : "disabled") << std::endl;
+    }
+    if (dumpDown && !tracingKeysDown[1]) {
+        traceDumpRequested = true;
+    }
+    tracingKeysDown[0] = toggleDown;
+    tracingKeysDown[1] = dumpDown;
+
+    // Home shows the whole board again
+    static bool fitKeyDown = false;
+    const bool fitDown = glfwGetKey(window, GLFW_KEY_HOME) == GLFW_PRESS;
+    if (fitDown && !fitKeyDown) {
+        int windowWidth, windowHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        camera.Fit(boardSize, glm::vec2(windowWidth, windowHeight));
+        redrawRequested = true;
+    }
+    fitKeyDown = fitDown;
+
+    // space pauses/resumes, N runs one generation
+    static bool pacingKeysDown[2] = { false, false };
+    const bool pauseDown = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+    const bool stepDown = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+    if (pauseDown && !pacingKeysDown[0]) {
+        userPaused = !userPaused;
+        std::cout << (userPaused ? "Paused" : "Resumed") << std::endl;
+    }
+    if (stepDown && !pacingKeysDown[1]) {
+        singleStepRequests++;
+    }
+    pacingKeysDown[0] = pauseDown;
+    pacingKeysDown[1] = stepDown;
+
+    // left/right step one generation back/forward; holding the key repeats after a short delay
+    static double scrubHeldSince = 0.0;
+    const int direction = (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) - (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS);
+    if (direction == 0) {
+        scrubHeldSince = 0.0;
+    }
+    else if (scrubHeldSince == 0.0) {
+        scrubHeldSince = glfwGetTime();
+        scrubSteps = direction;
+    }
+    else if (glfwGetTime() - scrubHeldSince > 0.3) {
+        scrubSteps = direction;
+    }
+
+    inputHeld = direction != 0 ||
+        glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS ||
+        glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS ||
+        glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS;
+}
+
+// start a readback of the current generation if any consumer wants it; edited reads it again
+// after SetCell. With every slot busy, a recording (which needs every generation) or an edit
+// waits for the pending readbacks to free one; otherwise the generation is skipped and a due
+// checkpoint counts as dropped
+// --------------------------------------------------------------------------------------------
+double RequestSnapshot(SimulationShader& simulationShader, SnapshotConsumers& consumers, uint64_t generation, bool edited)
+{
+    if (edited ? !consumers.WantsEdits() : !consumers.WantsGeneration(generation)) {
+        return 0.0;
+    }
+    TRACE_ZONE("request snapshot");
+    const double captureStart = glfwGetTime();
+    bool started = simulationShader.RequestStateReadback(generation, edited);
+    if (!started && (consumers.historyRecorder || edited)) {
+        CollectSnapshots(simulationShader, consumers, true);
+        started = simulationShader.RequestStateReadback(generation, edited);
+    }
+    const double seconds = glfwGetTime() - captureStart;
+    if (!edited && consumers.checkpointWriter.IsDue(generation)) {
+        if (started) {
+            consumers.checkpointWriter.AddCaptureTime(seconds);
+        }
+        else {
+            consumers.checkpointWriter.AddDropped();
+        }
+    }
+    return seconds;
+}
+
+// hand finished state readbacks to their consumers; without wait it never waits on the GPU,
+// with it every pending readback is finished. Returns the time spent when something was collected
+// -------------------------------------------------------------------------------------------------
+double CollectSnapshots(SimulationShader& simulationShader, SnapshotConsumers& consumers, bool wait)
+{
+    TRACE_ZONE("collect snapshots");
+    CheckpointWriter& checkpointWriter = consumers.checkpointWriter;
+
+    static BitGrid readbackGrid;
+    uint64_t snapshotGeneration = 0;
+    bool edited = false;
+
+    const double collectStart = glfwGetTime();
+    bool collected = false;
+    double captureStart = collectStart;
+    while (simulationShader.PollStateReadback(snapshotGeneration, edited, readbackGrid, wait)) {
+        auto snapshot = std::make_shared<GridSnapshot>();
+        snapshot->generation = snapshotGeneration;
+        snapshot->grid = std::move(readbackGrid);
+        snapshot->edited = edited;
+        if (!edited && checkpointWriter.IsDue(snapshotGeneration)) {
+            checkpointWriter.AddCaptureTime(glfwGetTime() - captureStart);
+        }
+        DeliverSnapshot(consumers, std::move(snapshot));
+        captureStart = glfwGetTime();
+        collected = true;
+    }
+    return collected ? glfwGetTime() - collectStart : 0.0;
+}
+
+// hand generations copied out by the simulation thread to their consumers
+// -----------------------------------------------------------------------
+double CollectEngineSnapshots(LifeEngine& engine, SnapshotConsumers& consumers)
+{
+    TRACE_ZONE("collect snapshots");
+    const double collectStart = glfwGetTime();
+    bool collected = false;
+    GridSnapshotPtr snapshot;
+    while (engine.PopSnapshot(snapshot)) {
+        DeliverSnapshot(consumers, snapshot);
+        collected = true;
+    }
+    return collected ? glfwGetTime() - collectStart : 0.0;
+}
+
+// an edited board is recorded and restarts the rewind buffer; checkpoints keep their schedule
+// ------------------------------------------------------------------------------------------
+void DeliverSnapshot(SnapshotConsumers& consumers, const GridSnapshotPtr& snapshot)
+{
+    if (!snapshot->edited && consumers.checkpointWriter.IsDue(snapshot->generation)) {
+        consumers.checkpointWriter.Submit(snapshot);
+    }
+    if (consumers.historyRecorder) {
+        consumers.historyRecorder->Record(snapshot);
+    }
+    if (consumers.rewindBuffer.IsDue(snapshot->generation) || (snapshot->edited && consumers.rewindBuffer.Enabled())) {
+        consumers.rewindBuffer.Store(snapshot);
+    }
+}
+
+// reduce the new generation to BoardStats on the GPU; only waits when every slot is in flight,
+// so the stream never has gaps
+// ---------------------------------------------------------------------------------------------
+void RequestStats(SimulationShader& simulationShader, StatsWriter& statsWriter, uint64_t generation)
+{
+    TRACE_ZONE("request stats");
+    while (!simulationShader.RequestStats(generation)) {
+        uint64_t statsGeneration = 0;
+        BoardStats stats;
+        if (simulationShader.PollStats(statsGeneration, stats, true)) {
+            statsWriter.Write(statsGeneration, stats);
+        }
+    }
+}
+
+// write the stats the GPU has finished, in generation order; wait drains every pending request
+// -------------------------------------------------------------------------------------------
+void CollectStats(SimulationShader& simulationShader, StatsWriter& statsWriter, bool wait)
+{
+    uint64_t statsGeneration = 0;
+    BoardStats stats;
+    while (simulationShader.HasPendingStats()) {
+        if (simulationShader.PollStats(statsGeneration, stats, wait)) {
+            statsWriter.Write(statsGeneration, stats);
+        }
+        else if (!wait) {
+            break;
+        }
+    }
+}
+
+// left mouse paints live cells, right mouse clears them, wherever the camera shows the cursor
+// -------------------------------------------------------------------------------------------
+void CollectMouseEdits(GLFWwindow* window, unsigned int boardWidth, unsigned int boardHeight, std::vector<CellEdit>& edits)
+{
+    static int64_t lastCell = -1;
+    const bool paint = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    const bool erase = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+    if (!paint && !erase) {
+        lastCell = -1;
+        return;
+    }
+
+    double cursorX, cursorY;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    int windowWidth, windowHeight;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    if (cursorX < 0.0 || cursorY < 0.0 || cursorX >= windowWidth || cursorY >= windowHeight) {
+        return;
+    }
+    const glm::vec2 cellPos = camera.ScreenToCell(glm::vec2(cursorX, cursorY), glm::vec2(windowWidth, windowHeight));
+    if (cellPos.x < 0.0f || cellPos.y < 0.0f || cellPos.x >= float(boardWidth) || cellPos.y >= float(boardHeight)) {
+        return;
+    }
+    const uint32_t x = uint32_t(cellPos.x);
+    const uint32_t y = uint32_t(cellPos.y);
+    // holding the button still only edits each cell once
+    const int64_t cell = int64_t(y) * boardWidth + x;
+    if (cell == lastCell) {
+        return;
+    }
+    lastCell = cell;
+    edits.push_back(CellEdit{ x, y, paint });
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -165,6 +885,38 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+    redrawRequested = true;
+}
+
+// glfw: the window contents were damaged (uncovered, restored, ...) and need to be drawn again
+// --------------------------------------------------------------------------------------------
+void window_refresh_callback(GLFWwindow*)
+{
+    redrawRequested = true;
+}
+
+// glfw: dragging with the middle mouse button pans the view
+// ---------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) {
+        camera.Pan(glm::vec2(float(xpos) - lastX, float(ypos) - lastY));
+        redrawRequested = true;
+    }
+    lastX = float(xpos);
+    lastY = float(ypos);
+}
+
+// glfw: the scroll wheel zooms, keeping the cell under the cursor in place
+// ------------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double, double yoffset)
+{
+    double cursorX, cursorY;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    int windowWidth, windowHeight;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    camera.ZoomAt(std::pow(1.25f, float(yoffset)), glm::vec2(cursorX, cursorY), glm::vec2(windowWidth, windowHeight));
+    redrawRequested = true;
 }
 
 void CreateRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO) {
@@ -207,9 +959,42 @@ void CreateRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO) {
 }
 
 
-void DeleteRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO, GLuint& renderTexture) {
+// colours for cell ages 0..255: newborn cells flash white, settle to the usual cyan and
+// turn orange, then red the longer they survive (on a log scale, as most cells die young)
+// ------------------------------------------------------------------------------------
+GLuint CreateAgePalette()
+{
+    const glm::vec3 stops[] = {
+        glm::vec3(1.0f, 1.0f, 1.0f),
+        glm::vec3(0.361f, 0.89f, 0.82f),
+        glm::vec3(0.95f, 0.62f, 0.18f),
+        glm::vec3(0.75f, 0.12f, 0.16f),
+    };
+    const size_t lastStop = std::size(stops) - 1;
+
+    std::vector<uint8_t> texels(256 * 4);
+    for (size_t age = 0; age < 256; age++) {
+        const float t = std::log2(float(std::max<size_t>(age, 1))) / 8.0f * lastStop;
+        const size_t stop = std::min(size_t(t), lastStop - 1);
+        const glm::vec3 color = glm::mix(stops[stop], stops[stop + 1], std::min(t - stop, 1.0f));
+        for (size_t channel = 0; channel < 3; channel++) {
+            texels[age * 4 + channel] = uint8_t(color[channel] * 255.0f + 0.5f);
+        }
+        texels[age * 4 + 3] = 255;
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+void DeleteRenderQuad(GLuint& VAO, GLuint& VBO, GLuint& EBO) {
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
     glDeleteVertexArrays(1, &VAO);
-    glDeleteTextures(1, &renderTexture);
 }
@@ -0,0 +1,62 @@
+#include "Metrics.h"
+
+#include <cstdio>
+
+Metrics::Metrics(double reportInterval) : reportInterval(reportInterval) {}
+
+size_t Metrics::Register(const std::string& name) {
+    for (size_t i = 0; i < this->metrics.size(); i++) {
+        if (this->metrics[i].name == name) {
+            return i;
+        }
+    }
+    this->metrics.push_back(Metric{ name, LatencyHistogram(), LatencyHistogram() });
+    return this->metrics.size() - 1;
+}
+
+void Metrics::Record(size_t id, uint64_t valueNs) {
+    Metric& metric = this->metrics[id];
+    metric.interval.Record(valueNs);
+    metric.total.Record(valueNs);
+}
+
+void Metrics::MaybeReport(double now) {
+    if (this->reportInterval <= 0.0) {
+        return;
+    }
+    if (this->lastReport < 0.0) {
+        this->lastReport = now;
+        return;
+    }
+    if (now - this->lastReport < this->reportInterval) {
+        return;
+    }
+
+    std::printf("--- last %.1fs ---\n", now - this->lastReport);
+    for (Metric& metric : this->metrics) {
+        if (metric.interval.Count() > 0) {
+            printLine(metric.name, metric.interval);
+        }
+        metric.interval.Reset();
+    }
+    std::fflush(stdout);
+    this->lastReport = now;
+}
+
+void Metrics::PrintSummary() const {
+    std::printf("--- whole run ---\n");
+    for (const Metric& metric : this->metrics) {
+        if (metric.total.Count() > 0) {
+            printLine(metric.name, metric.total);
+        }
+    }
+    std::fflush(stdout);
+}
+
+void Metrics::printLine(const std::string& name, const LatencyHistogram& histogram) {
+    const double ms = 1e-6;
+    std::printf("%-18s n=%-8llu p50 %8.3f ms  p99 %8.3f ms  p999 %8.3f ms  max %8.3f ms\n",
+        name.c_str(), (unsigned long long)histogram.Count(),
+        histogram.Percentile(50.0) * ms, histogram.Percentile(99.0) * ms,
+        histogram.Percentile(99.9) * ms, histogram.Max() * ms);
+}
@@ -0,0 +1,173 @@
+#include "ObjectLabeler.h"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+#include <Trace.h>
+
+namespace {
+    // fewer rows per band are not worth a thread
+    const size_t MIN_BAND_ROWS = 64;
+
+    // first bits of the runs of live cells in word i of row
+    inline uint64_t runStarts(const uint64_t* row, size_t i) {
+        const uint64_t carry = i > 0 ? row[i - 1] >> 63 : 0;
+        return row[i] & ~((row[i] << 1) | carry);
+    }
+
+    template <typename Body>
+    void forEachBand(size_t bands, size_t height, Body body) {
+        std::vector<std::thread> workers;
+        for (size_t band = 1; band < bands; band++) {
+            workers.emplace_back([&body, band, bands, height]() {
+                Trace::SetThreadName("object labeler");
+                body(band * height / bands, (band + 1) * height / bands);
+            });
+        }
+        body(0, height / bands);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+ObjectLabeler::ObjectLabeler(unsigned distance, unsigned threads)
+    : distance(std::max(distance, 1u)), threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+const std::vector<LabeledObject>& ObjectLabeler::Label(const BitGrid& grid) {
+    TRACE_ZONE("ObjectLabeler::Label");
+    const size_t height = grid.Height();
+    // every band must be at least distance rows high so joins only reach into the band below
+    const size_t bands = std::max<size_t>(1, std::min<size_t>(this->threads, height / std::max<size_t>(MIN_BAND_ROWS, this->distance)));
+
+    // count the runs of every row, then fill them in at their final positions
+    this->rowStarts.assign(height + 1, 0);
+    forEachBand(bands, height, [this, &grid](size_t firstRow, size_t lastRow) {
+        for (size_t y = firstRow; y < lastRow; y++) {
+            uint32_t count = 0;
+            for (size_t i = 0; i < grid.WordsPerRow(); i++) {
+                count += uint32_t(std::popcount(runStarts(grid.Row(y), i)));
+            }
+            this->rowStarts[y + 1] = count;
+        }
+    });
+    for (size_t y = 0; y < height; y++) {
+        this->rowStarts[y + 1] += this->rowStarts[y];
+    }
+    this->runs.resize(this->rowStarts[height]);
+    this->parents.resize(this->runs.size());
+
+    forEachBand(bands, height, [this, &grid](size_t firstRow, size_t lastRow) {
+        findRuns(grid, firstRow, lastRow);
+        joinRows(firstRow, lastRow, firstRow);
+    });
+    // where bands meet, join the first rows of each band with the rows of the band below
+    for (size_t band = 1; band < bands; band++) {
+        const size_t firstRow = band * height / bands;
+        joinRows(firstRow, std::min(firstRow + this->distance, height), 0);
+    }
+
+    // a parent never follows its child, so one pass in run order resolves every root
+    this->objects.clear();
+    for (uint32_t run = 0; run < this->runs.size(); run++) {
+        Run& current = this->runs[run];
+        if (this->parents[run] == run) {
+            current.object = uint32_t(this->objects.size());
+            LabeledObject object;
+            object.minX = current.start;
+            object.minY = current.y;
+            object.maxX = current.end;
+            object.maxY = current.y;
+            this->objects.push_back(object);
+        }
+        else {
+            current.object = this->runs[this->parents[run]].object;
+        }
+        LabeledObject& object = this->objects[current.object];
+        object.population += current.end - current.start + 1;
+        object.minX = std::min(object.minX, current.start);
+        object.maxX = std::max(object.maxX, current.end);
+        object.maxY = current.y;
+    }
+    return this->objects;
+}
+
+void ObjectLabeler::findRuns(const BitGrid& grid, size_t firstRow, size_t lastRow) {
+    const size_t words = grid.WordsPerRow();
+    for (size_t y = firstRow; y < lastRow; y++) {
+        const uint64_t* row = grid.Row(y);
+        uint32_t run = this->rowStarts[y];
+        for (size_t i = 0; i < words; i++) {
+            uint64_t starts = runStarts(row, i);
+            while (starts != 0) {
+                const size_t bit = size_t(std::countr_zero(starts));
+                starts &= starts - 1;
+                // the run ends before the first dead cell after its start, or at the end of the row
+                size_t word = i;
+                uint64_t dead = ~row[word] & (~0ull << bit);
+                while (dead == 0 && word + 1 < words) {
+                    word++;
+                    dead = ~row[word];
+                }
+                Run& current = this->runs[run];
+                current.y = uint32_t(y);
+                current.start = uint32_t(i * 64 + bit);
+                current.end = uint32_t(dead != 0 ? word * 64 + std::countr_zero(dead) - 1 : words * 64 - 1);
+                this->parents[run] = run;
+                run++;
+            }
+        }
+    }
+}
+
+void ObjectLabeler::joinRows(size_t firstRow, size_t lastRow, size_t floorRow) {
+    const uint32_t distance = this->distance;
+    for (size_t y = firstRow; y < lastRow; y++) {
+        const uint32_t first = this->rowStarts[y], last = this->rowStarts[y + 1];
+        // runs of the same row: joined when at most distance - 1 dead cells lie between them
+        for (uint32_t run = first + 1; run < last; run++) {
+            if (this->runs[run].start - this->runs[run - 1].end <= distance) {
+                join(run - 1, run);
+            }
+        }
+        // rows below: joined when they overlap after widening by distance
+        for (size_t below = y > distance ? y - distance : 0; below < y; below++) {
+            if (below < floorRow) {
+                continue;
+            }
+            uint32_t other = this->rowStarts[below];
+            const uint32_t otherLast = this->rowStarts[below + 1];
+            for (uint32_t run = first; run < last && other < otherLast; run++) {
+                const Run& current = this->runs[run];
+                while (other < otherLast && this->runs[other].end + distance < current.start) {
+                    other++;
+                }
+                for (uint32_t candidate = other; candidate < otherLast && this->runs[candidate].start <= current.end + distance; candidate++) {
+                    join(run, candidate);
+                }
+            }
+        }
+    }
+}
+
+uint32_t ObjectLabeler::find(uint32_t run) {
+    // path halving
+    while (this->parents[run] != run) {
+        this->parents[run] = this->parents[this->parents[run]];
+        run = this->parents[run];
+    }
+    return run;
+}
+
+void ObjectLabeler::join(uint32_t a, uint32_t b) {
+    a = find(a);
+    b = find(b);
+    // the earlier run becomes the root, which keeps every parent before its children
+    if (a < b) {
+        this->parents[b] = a;
+    }
+    else if (b < a) {
+        this->parents[a] = b;
+    }
+}
@@ -0,0 +1,183 @@
+#include "Pattern.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <tuple>
+
+#include <BoardStats.h>
+
+namespace {
+    using Square = std::array<uint64_t, Pattern::MAX_SIZE>;
+
+    inline uint64_t mix(uint64_t x) {
+        // splitmix64 finalizer
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    inline uint64_t reverseBits(uint64_t x) {
+        x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+        x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+        x = ((x >> 8) & 0x00FF00FF00FF00FFull) | ((x & 0x00FF00FF00FF00FFull) << 8);
+        x = ((x >> 16) & 0x0000FFFF0000FFFFull) | ((x & 0x0000FFFF0000FFFFull) << 16);
+        return (x >> 32) | (x << 32);
+    }
+
+    // transposes the size x size bit matrix in the low corner of rows, size a power of two:
+    // each pass swaps the off-diagonal blocks of every 2j x 2j block, all bits of a row at once
+    void transpose(Square& rows, size_t size) {
+        uint64_t mask = ~0ull >> (64 - size / 2);
+        for (size_t j = size / 2; j != 0; j >>= 1, mask ^= mask << j) {
+            for (size_t k = 0; k < size; k = ((k | j) + 1) & ~j) {
+                const uint64_t t = ((rows[k] >> j) ^ rows[k | j]) & mask;
+                rows[k | j] ^= t;
+                rows[k] ^= t << j;
+            }
+        }
+    }
+
+    // the orientation of a pattern given its rows and those of its transpose
+    struct Orientations {
+        uint32_t width, height;
+        // only the first rows of the square a small pattern needs are ever filled in
+        Square rows, transposed;
+
+        explicit Orientations(const Pattern& pattern) : width(pattern.width), height(pattern.height) {
+            const size_t size = std::bit_ceil(std::max<size_t>({ this->width, this->height, 2 }));
+            std::copy(pattern.rows.begin(), pattern.rows.end(), this->rows.begin());
+            std::fill(this->rows.begin() + this->height, this->rows.begin() + size, 0);
+            std::copy_n(this->rows.begin(), size, this->transposed.begin());
+            transpose(this->transposed, size);
+        }
+
+        void Get(int orientation, uint32_t& width, uint32_t& height, Square& result) const {
+            const bool transposed = orientation & 1;
+            width = transposed ? this->height : this->width;
+            height = transposed ? this->width : this->height;
+            const Square& source = transposed ? this->transposed : this->rows;
+            for (size_t y = 0; y < height; y++) {
+                const uint64_t row = source[(orientation & 4) ? height - 1 - y : y];
+                result[y] = (orientation & 2) ? reverseBits(row) >> (64 - width) : row;
+            }
+        }
+    };
+
+    Pattern toPattern(uint32_t width, uint32_t height, const Square& rows) {
+        Pattern pattern;
+        pattern.width = width;
+        pattern.height = height;
+        pattern.rows.assign(rows.begin(), rows.begin() + height);
+        return pattern;
+    }
+}
+
+bool Pattern::FromGrid(const BitGrid& grid, Pattern& pattern) {
+    const BoardStats stats = BoardStats::Of(grid);
+    pattern.width = stats.population ? stats.maxX - stats.minX + 1 : 0;
+    pattern.height = stats.population ? stats.maxY - stats.minY + 1 : 0;
+    if (pattern.width > MAX_SIZE || pattern.height > MAX_SIZE) {
+        return false;
+    }
+    pattern.rows.assign(pattern.height, 0);
+    const size_t shift = stats.minX % 64;
+    for (size_t y = 0; y < pattern.height; y++) {
+        // the box spans at most two words of the row
+        const uint64_t* row = grid.Row(stats.minY + y) + stats.minX / 64;
+        uint64_t bits = row[0] >> shift;
+        if (shift + pattern.width > 64) {
+            bits |= row[1] << (64 - shift);
+        }
+        pattern.rows[y] = bits & (~0ull >> (64 - pattern.width));
+    }
+    return true;
+}
+
+void Pattern::FromRows(const uint64_t* rows, size_t count, size_t stride, Pattern& pattern) {
+    size_t first = count, last = 0;
+    uint64_t columns = 0;
+    for (size_t y = 0; y < count; y++) {
+        const uint64_t row = rows[y * stride];
+        if (row != 0) {
+            first = std::min(first, y);
+            last = y;
+            columns |= row;
+        }
+    }
+    if (columns == 0) {
+        pattern.width = pattern.height = 0;
+        pattern.rows.clear();
+        return;
+    }
+    const int minX = std::countr_zero(columns);
+    pattern.width = uint32_t(64 - std::countl_zero(columns) - minX);
+    pattern.height = uint32_t(last - first + 1);
+    pattern.rows.resize(pattern.height);
+    for (size_t y = 0; y < pattern.height; y++) {
+        pattern.rows[y] = rows[(first + y) * stride] >> minX;
+    }
+}
+
+Pattern Pattern::Oriented(int orientation) const {
+    if (this->height == 0) {
+        return *this;
+    }
+    uint32_t width, height;
+    Square rows;
+    Orientations(*this).Get(orientation, width, height, rows);
+    return toPattern(width, height, rows);
+}
+
+Pattern Pattern::Canonical() const {
+    if (this->height == 0) {
+        return *this;
+    }
+    const Orientations orientations(*this);
+    uint32_t bestWidth = this->width, bestHeight = this->height;
+    Square best;
+    std::copy_n(orientations.rows.begin(), bestHeight, best.begin());
+    uint32_t width, height;
+    Square candidate;
+    for (int orientation = 1; orientation < 8; orientation++) {
+        orientations.Get(orientation, width, height, candidate);
+        // the same order as operator<, without building the candidates as patterns
+        const bool smaller = std::tie(width, height) != std::tie(bestWidth, bestHeight)
+            ? std::tie(width, height) < std::tie(bestWidth, bestHeight)
+            : std::lexicographical_compare(candidate.begin(), candidate.begin() + height, best.begin(), best.begin() + height);
+        if (smaller) {
+            bestWidth = width;
+            bestHeight = height;
+            std::copy_n(candidate.begin(), height, best.begin());
+        }
+    }
+    return toPattern(bestWidth, bestHeight, best);
+}
+
+uint64_t Pattern::Hash() const {
+    uint64_t hash = mix((uint64_t(this->width) << 32 | this->height) + 0x9E3779B97F4A7C15ull);
+    for (uint64_t row : this->rows) {
+        hash = mix(hash ^ row) + 0x9E3779B97F4A7C15ull;
+    }
+    return hash;
+}
+
+std::string Pattern::Code() const {
+    std::string code = std::to_string(this->width) + "x" + std::to_string(this->height) + "_";
+    char hex[20];
+    for (size_t y = 0; y < this->height; y++) {
+        std::snprintf(hex, sizeof(hex), y ? ".%llx" : "%llx", (unsigned long long)this->rows[y]);
+        code += hex;
+    }
+    return code;
+}
+
+bool Pattern::operator==(const Pattern& other) const {
+    return std::tie(this->width, this->height, this->rows) == std::tie(other.width, other.height, other.rows);
+}
+
+bool Pattern::operator<(const Pattern& other) const {
+    return std::tie(this->width, this->height, this->rows) < std::tie(other.width, other.height, other.rows);
+}
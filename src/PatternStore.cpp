@@ -0,0 +1,93 @@
+#include "PatternStore.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char STORE_MAGIC[8] = { 'G', 'O', 'L', 'P', 'A', 'T', 'S', '1' };
+
+    struct PatternRecord {
+        uint64_t hash;
+        uint32_t width;
+        uint32_t height;
+    };
+    static_assert(sizeof(PatternRecord) == 16, "pattern records are written as is");
+}
+
+PatternStore::PatternStore(const std::string& path) {
+    const bool exists = std::filesystem::exists(path);
+    if (exists && !load(path)) {
+        return;
+    }
+    this->file = std::fopen(path.c_str(), "ab");
+    if (!this->file) {
+        std::cout << "ERROR::PATTERN_STORE::CANNOT_OPEN_FILE(" << path << ")" << std::endl;
+        return;
+    }
+    if (!exists) {
+        std::fwrite(STORE_MAGIC, sizeof(STORE_MAGIC), 1, this->file);
+    }
+}
+
+PatternStore::~PatternStore() {
+    if (this->file) {
+        std::fclose(this->file);
+    }
+}
+
+uint64_t PatternStore::Add(const Pattern& pattern) {
+    return AddCanonical(pattern.Canonical());
+}
+
+uint64_t PatternStore::AddCanonical(const Pattern& canonical) {
+    const uint64_t key = canonical.Hash();
+    const auto [entry, inserted] = this->patterns.try_emplace(key, canonical);
+    if (!inserted) {
+        if (!(entry->second == canonical)) {
+            std::cout << "ERROR::PATTERN_STORE::HASH_COLLISION(" << entry->second.Code() << " " << canonical.Code() << ")" << std::endl;
+        }
+        return key;
+    }
+    this->added++;
+    if (this->file) {
+        const PatternRecord record = { key, canonical.width, canonical.height };
+        std::fwrite(&record, sizeof(record), 1, this->file);
+        std::fwrite(canonical.rows.data(), sizeof(uint64_t), canonical.rows.size(), this->file);
+    }
+    return key;
+}
+
+const Pattern* PatternStore::Find(uint64_t key) const {
+    const auto entry = this->patterns.find(key);
+    return entry != this->patterns.end() ? &entry->second : nullptr;
+}
+
+bool PatternStore::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[8];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, STORE_MAGIC, sizeof(magic)) != 0) {
+        std::cout << "ERROR::PATTERN_STORE::INVALID_FILE(" << path << ")" << std::endl;
+        return false;
+    }
+    PatternRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        // check the sizes before they turn into an allocation
+        if (record.width > Pattern::MAX_SIZE || record.height > Pattern::MAX_SIZE) {
+            std::cout << "ERROR::PATTERN_STORE::CORRUPT_FILE(" << path << ")" << std::endl;
+            return false;
+        }
+        Pattern pattern;
+        pattern.width = record.width;
+        pattern.height = record.height;
+        pattern.rows.resize(record.height);
+        if (!file.read(reinterpret_cast<char*>(pattern.rows.data()), pattern.rows.size() * sizeof(uint64_t))) {
+            // a record cut short by a crash; appending after it would misalign everything
+            std::cout << "ERROR::PATTERN_STORE::TRUNCATED_FILE(" << path << ")" << std::endl;
+            return false;
+        }
+        this->patterns.emplace(record.hash, std::move(pattern));
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    int openCounter(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        // user space only; this is all an unprivileged container usually gets
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+}
+
+PerfCounters::PerfCounters() {
+    fds.fill(-1);
+#ifdef __linux__
+    const uint64_t configs[CounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (int i = 0; i < CounterCount; i++) {
+        this->fds[i] = openCounter(PERF_TYPE_HARDWARE, configs[i]);
+        if (this->fds[i] < 0 && this->reason.empty()) {
+            this->reason = std::string("perf_event_open failed: ") + std::strerror(errno) +
+                " (check /proc/sys/kernel/perf_event_paranoid or container seccomp policy)";
+        }
+    }
+#else
+    this->reason = "hardware counters are only supported on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : this->fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::AnyAvailable() const {
+    for (int fd : this->fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+    for (int fd : this->fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void PerfCounters::Stop() {
+#ifdef __linux__
+    for (int fd : this->fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::Read(Counter counter, uint64_t& value) const {
+#ifdef __linux__
+    const int fd = this->fds[counter];
+    if (fd < 0) {
+        return false;
+    }
+    // value, time enabled, time running
+    uint64_t data[3];
+    if (read(fd, data, sizeof(data)) != ssize_t(sizeof(data)) || data[2] == 0) {
+        return false;
+    }
+    // the kernel multiplexes when there are more events than hardware counters
+    value = data[2] < data[1] ? uint64_t(double(data[0]) * double(data[1]) / double(data[2])) : data[0];
+    return true;
+#else
+    (void)counter;
+    (void)value;
+    return false;
+#endif
+}
+
+const char* PerfCounters::Name(Counter counter) {
+    switch (counter) {
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case LlcMisses: return "LLC misses";
+    case BranchMisses: return "branch misses";
+    default: return "?";
+    }
+}
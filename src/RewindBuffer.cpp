@@ -0,0 +1,160 @@
+#include "RewindBuffer.h"
+
+#include <algorithm>
+
+#include <DeltaCodec.h>
+#include <LifeRule.h>
+#include <Trace.h>
+
+RewindBuffer::RewindBuffer(uint64_t interval, size_t maxBytes, Boundary boundary)
+    : interval(std::max<uint64_t>(interval, 1)), maxBytes(maxBytes), boundary(boundary) {
+    if (Enabled()) {
+        this->worker = std::thread(&RewindBuffer::workerLoop, this);
+    }
+}
+
+RewindBuffer::~RewindBuffer() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_one();
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+}
+
+void RewindBuffer::Store(GridSnapshotPtr snapshot) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    const BitGrid& grid = snapshot->grid;
+
+    const bool restart = this->entries.empty() || snapshot->edited ||
+        grid.Width() != this->base.Width() || grid.Height() != this->base.Height() ||
+        snapshot->generation <= this->entries.back().generation;
+    if (restart) {
+        this->base = grid;
+        this->entries.clear();
+        this->entries.push_back(Entry{ snapshot->generation, {} });
+        this->storedBytes = this->base.Words().size() * sizeof(uint64_t);
+        this->newest = std::move(snapshot);
+        this->restarts++;
+        return;
+    }
+
+    Entry entry;
+    entry.generation = snapshot->generation;
+    DeltaCodec::EncodeXor(grid.Words().data(), this->newest->grid.Words().data(), grid.Words().size(), entry.delta);
+    this->storedBytes += entry.delta.size();
+    this->entries.push_back(std::move(entry));
+    this->newest = std::move(snapshot);
+
+    // over budget: fold the oldest delta into the base and forget the oldest generation
+    std::vector<uint64_t>& baseWords = this->base.Words();
+    while (this->storedBytes > this->maxBytes && this->entries.size() > 1) {
+        Entry& second = this->entries[1];
+        DeltaCodec::DecodeXorInto(second.delta.data(), second.delta.size(), baseWords.data(), baseWords.size());
+        this->storedBytes -= second.delta.size();
+        second.delta.clear();
+        second.delta.shrink_to_fit();
+        this->entries.pop_front();
+    }
+}
+
+uint64_t RewindBuffer::OldestGeneration() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->entries.empty() ? 0 : this->entries.front().generation;
+}
+
+void RewindBuffer::Request(uint64_t generation) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->hasRequest = true;
+        this->requestedGeneration = generation;
+    }
+    this->wake.notify_one();
+}
+
+bool RewindBuffer::TakeResult(GridSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->hasResult) {
+        return false;
+    }
+    snapshot = std::move(this->result);
+    this->hasResult = false;
+    return true;
+}
+
+bool RewindBuffer::decodeEntry(uint64_t generation, GridSnapshot& snapshot) const {
+    auto it = std::upper_bound(this->entries.begin(), this->entries.end(), generation,
+        [](uint64_t value, const Entry& entry) { return value < entry.generation; });
+    if (it == this->entries.begin()) {
+        return false;
+    }
+    const size_t target = size_t(it - this->entries.begin()) - 1;
+
+    snapshot.generation = this->entries[target].generation;
+    snapshot.grid = this->base;
+    std::vector<uint64_t>& words = snapshot.grid.Words();
+    for (size_t i = 1; i <= target; i++) {
+        const Entry& entry = this->entries[i];
+        DeltaCodec::DecodeXorInto(entry.delta.data(), entry.delta.size(), words.data(), words.size());
+    }
+    return true;
+}
+
+void RewindBuffer::workerLoop() {
+    Trace::SetThreadName("rewind worker");
+
+    // generations segmentStart, segmentStart + 1, ... rebuilt from one stored entry
+    std::vector<BitGrid> segment;
+    uint64_t segmentStart = 0;
+    uint64_t segmentRestarts = 0;
+
+    while (true) {
+        uint64_t target;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this]() { return this->stopping || this->hasRequest; });
+            if (this->stopping) {
+                return;
+            }
+            target = this->requestedGeneration;
+            this->hasRequest = false;
+
+            const bool cached = !segment.empty() && segmentRestarts == this->restarts &&
+                target >= segmentStart && target < segmentStart + this->interval;
+            if (!cached) {
+                GridSnapshot start;
+                if (!decodeEntry(target, start)) {
+                    continue;
+                }
+                segment.clear();
+                segment.push_back(std::move(start.grid));
+                segmentStart = start.generation;
+                segmentRestarts = this->restarts;
+            }
+        }
+
+        // re-simulate forward outside the lock; a newer request abandons this one
+        TRACE_ZONE("rewind re-simulate");
+        while (segmentStart + segment.size() - 1 < target) {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (this->stopping || this->hasRequest) {
+                    break;
+                }
+            }
+            BitGrid next;
+            LifeRule::Step(segment.back(), next, this->boundary);
+            segment.push_back(std::move(next));
+        }
+        if (segmentStart + segment.size() - 1 < target) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->result.generation = target;
+        this->result.grid = segment[target - segmentStart];
+        this->hasResult = true;
+    }
+}
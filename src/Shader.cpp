@@ -10,7 +10,9 @@
 // Constructors
 Shader::Shader() : Shader("src/shaders/shader.vert", "src/shaders/shader.frag") {}
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+Shader::Shader(const char* vertexPath, const char* fragmentPath) : Shader(vertexPath, fragmentPath, "") {}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines) {
 	std::string vertexCode;
 	std::string fragmentCode;
 	std::ifstream vShaderFile;
@@ -37,6 +39,11 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	catch (std::ifstream::failure e) {
 		std::cout << "ERROR:SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
 	}
+	// #version has to stay the first line
+	if (!defines.empty()) {
+		const size_t versionEnd = fragmentCode.find('\n');
+		fragmentCode.insert(versionEnd == std::string::npos ? fragmentCode.size() : versionEnd + 1, defines);
+	}
 	const char* vShaderCode = vertexCode.c_str();
 	const char* fShaderCode = fragmentCode.c_str();
 
@@ -0,0 +1,64 @@
+#include "SimulationScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+SimulationScheduler::SimulationScheduler(double generationsPerSecond, unsigned maxCatchUp) : maxCatchUp(maxCatchUp) {
+    SetRate(generationsPerSecond, 0.0);
+}
+
+void SimulationScheduler::SetRate(double generationsPerSecond, double now) {
+    this->rate = std::max(generationsPerSecond, 0.0);
+    this->period = this->rate > 0.0 ? 1.0 / this->rate : 0.0;
+    // restart the timeline so the new rate applies from now, without a burst or a long wait
+    this->nextStep = now;
+}
+
+void SimulationScheduler::SetPaused(bool paused, double now) {
+    if (this->paused && !paused) {
+        this->nextStep = now;
+    }
+    this->paused = paused;
+}
+
+unsigned SimulationScheduler::StepsDue(double now) {
+    if (this->singleStepPending) {
+        this->singleStepPending = false;
+        this->nextStep = now + this->period;
+        return 1;
+    }
+    if (this->paused) {
+        return 0;
+    }
+    if (!this->started) {
+        this->started = true;
+        this->nextStep = now;
+    }
+    if (this->period <= 0.0) {
+        return 1;
+    }
+    if (now < this->nextStep) {
+        return 0;
+    }
+
+    const double late = std::floor((now - this->nextStep) / this->period);
+    const uint64_t due = late >= double(UINT32_MAX) ? UINT32_MAX : uint64_t(late) + 1;
+    const uint64_t steps = std::min<uint64_t>(due, uint64_t(this->maxCatchUp) + 1);
+    this->skipped += due - steps;
+    // dropped steps are skipped on the timeline too, keeping the phase
+    this->nextStep += double(due) * this->period;
+    return unsigned(steps);
+}
+
+double SimulationScheduler::TimeUntilNextStep(double now) const {
+    if (this->singleStepPending) {
+        return 0.0;
+    }
+    if (this->paused) {
+        return -1.0;
+    }
+    if (!this->started) {
+        return 0.0;
+    }
+    return std::max(this->nextStep - now, 0.0);
+}
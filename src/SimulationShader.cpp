@@ -1,72 +1,350 @@
 #include "SimulationShader.h"
 
-SimulationShader::SimulationShader(const char* vertexPath, const char* fragmentPath) : Shader(vertexPath, fragmentPath) {}
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <Trace.h>
+
+SimulationShader::SimulationShader(const char* vertexPath, const char* fragmentPath, bool trackAge, Boundary boundary)
+    : Shader(vertexPath, fragmentPath, std::string(trackAge ? "#define TRACK_AGE\n" : "") + BoundaryDefine(boundary)), trackAge(trackAge),
+      boundary(boundary), packShader(vertexPath, "src/shaders/pack.frag"), statsShader(vertexPath, "src/shaders/stats.frag") {}
 
 SimulationShader::~SimulationShader() {
     glDeleteBuffers(1, &this->VBO);
     glDeleteBuffers(1, &this->EBO);
     glDeleteVertexArrays(1, &this->VAO);
-    glDeleteFramebuffers(1, &this->FBO);
-    glDeleteTextures(1, &this->texture);
+    for (Tile& tile : this->tiles) {
+        glDeleteFramebuffers(2, tile.FBOs);
+        glDeleteTextures(2, tile.textures);
+        glDeleteTextures(2, tile.ages);
+    }
+    glDeleteFramebuffers(1, &this->haloFBO);
+
+    for (Readback& slot : this->readbacks) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.PBO);
+    }
+    glDeleteFramebuffers(1, &this->packFBO);
+    glDeleteTextures(1, &this->packTexture);
+    glDeleteProgram(this->packShader.ID);
+
+    for (Readback& slot : this->statsSlots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.PBO);
+    }
+    glDeleteFramebuffers(1, &this->statsFBO);
+    glDeleteTextures(2, this->statsTextures);
+    glDeleteProgram(this->statsShader.ID);
 }
 
-void SimulationShader::Initialize(size_t simWidth, size_t simHeight) {
+void SimulationShader::Initialize(size_t simWidth, size_t simHeight, size_t tileSize) {
     this->simWidth = simWidth;
     this->simHeight = simHeight;
 
+    // every tile texture carries a halo cell on each side
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    const size_t limit = size_t(maxTextureSize) - 2;
+    if (tileSize == 0) {
+        tileSize = (simWidth <= limit && simHeight <= limit) ? std::max(simWidth, simHeight) : std::min(AUTO_TILE_SIZE, limit / 64 * 64);
+    }
+    else if (tileSize > limit) {
+        std::cout << "ERROR::SIMULATION::TILE_SIZE_EXCEEDS_MAX_TEXTURE_SIZE(" << tileSize << " > " << limit << ")" << std::endl;
+        tileSize = limit / 64 * 64;
+    }
+    this->tileSize = tileSize;
+
     use();
     setIVec2("gridSize", glm::uvec2(simWidth, simHeight));
     setInt("currentState", 0);
+    if (this->trackAge) {
+        setInt("currentAge", 1);
+    }
 
     createSimulationQuad();
-    createTexture();
+    createTiles();
+    createReadbackResources();
 }
 
-void SimulationShader::ProvideInitialGrid(std::vector<float>& grid) {
-    assert(grid.size() == this->simWidth * this->simHeight);
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->simWidth, this->simHeight, GL_RED, GL_FLOAT, grid.data());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void SimulationShader::ProvideInitialGrid(const BitGrid& grid) {
+    assert(grid.Width() == this->simWidth && grid.Height() == this->simHeight);
+    // expanded one tile at a time so the board never exists as one byte per cell on the CPU
+    std::vector<GLubyte> cells;
+    for (Tile& tile : this->tiles) {
+        cells.resize(size_t(tile.size.x) * tile.size.y);
+        for (int y = 0; y < tile.size.y; y++) {
+            for (int x = 0; x < tile.size.x; x++) {
+                cells[size_t(y) * tile.size.x + x] = grid.Get(tile.origin.x + x, tile.origin.y + y) ? 255 : 0;
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 1, 1, tile.size.x, tile.size.y, GL_RED, GL_UNSIGNED_BYTE, cells.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void SimulationShader::RunSimulation() {
-    // bind to the simulation FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    glViewport(0, 0, this->simWidth, this->simHeight);
+    TRACE_ZONE("SimulationShader::RunSimulation");
+
+    exchangeHalos();
 
-    // setup shader and target texture
+    // setup shader
     use();
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, this->texture);
+    glBindVertexArray(this->VAO);
 
     //DebugSimulationTexture();
 
-    // draw
-    glBindVertexArray(this->VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-    DebugSimulationTexture();
+    // every tile reads its current texture and writes the interior of the other one
+    const size_t next = this->current ^ 1;
+    for (Tile& tile : this->tiles) {
+        glBindFramebuffer(GL_FRAMEBUFFER, tile.FBOs[next]);
+        glViewport(1, 1, tile.size.x, tile.size.y);
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        if (this->trackAge) {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, tile.ages[this->current]);
+            glActiveTexture(GL_TEXTURE0);
+        }
+        setIVec2("tileOrigin", tile.origin);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    this->current = next;
 
     // unbind the framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void SimulationShader::CopySimulationResultsToTexture(GLuint& targetTexture) {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    glBindTexture(GL_TEXTURE_2D, targetTexture);
-    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, 0, 0, this->simWidth, this->simHeight, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void SimulationShader::Draw(const Shader& renderShader, const glm::vec2& viewOrigin, const glm::vec2& viewSize,
+    const glm::ivec2& framebufferSize, bool zoomedOut) {
+    TRACE_ZONE("SimulationShader::Draw");
+    const glm::vec2 pixelsPerCell = glm::vec2(framebufferSize) / viewSize;
+
+    glEnable(GL_SCISSOR_TEST);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->VAO);
+    for (Tile& tile : this->tiles) {
+        // screen rectangle of the tile, skipped when it is outside the window
+        const glm::vec2 low = (glm::vec2(tile.origin) - viewOrigin) * pixelsPerCell;
+        const glm::vec2 high = (glm::vec2(tile.origin + tile.size) - viewOrigin) * pixelsPerCell;
+        const glm::ivec2 first = glm::max(glm::ivec2(glm::floor(low)), glm::ivec2(0));
+        const glm::ivec2 last = glm::min(glm::ivec2(glm::ceil(high)), framebufferSize);
+        if (last.x <= first.x || last.y <= first.y) {
+            continue;
+        }
+
+        if (this->trackAge) {
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, tile.ages[this->current]);
+            glActiveTexture(GL_TEXTURE0);
+        }
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        if (zoomedOut) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glScissor(first.x, first.y, last.x - first.x, last.y - first.y);
+        renderShader.setIVec2("tileOrigin", tile.origin);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void SimulationShader::SetCell(size_t x, size_t y, bool alive) {
+    if (x >= this->simWidth || y >= this->simHeight) {
+        return;
+    }
+    // neighbouring halos pick the change up at the next exchange
+    const Tile& tile = this->tiles[(y / this->tileSize) * this->tilesX + x / this->tileSize];
+    const GLubyte state = alive ? 255 : 0;
+    glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, GLint(x - tile.origin.x + 1), GLint(y - tile.origin.y + 1), 1, 1, GL_RED, GL_UNSIGNED_BYTE, &state);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void SimulationShader::DebugSimulationTexture() {
-    std::vector<GLfloat> pixels(this->simWidth * this->simHeight);
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    const Tile& tile = this->tiles[0];
+    std::vector<GLfloat> pixels(size_t(tile.size.x + 2) * (tile.size.y + 2));
+    glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, pixels.data());
     assert(1 == 1);
 }
 
+bool SimulationShader::RequestStateReadback(uint64_t generation, bool edited) {
+    if (this->readbackCount == READBACK_SLOTS) {
+        return false;
+    }
+    Readback& slot = this->readbacks[(this->readbackHead + this->readbackCount) % READBACK_SLOTS];
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->packFBO);
+    this->packShader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    // tiles start on word boundaries, so each lands in its own columns of the board's rows
+    glPixelStorei(GL_PACK_ROW_LENGTH, GLint(this->packWidth));
+    for (const Tile& tile : this->tiles) {
+        // pack 32 cells into every texel of the pack texture
+        const GLsizei texels = GLsizei((tile.size.x + 63) / 64 * 2);
+        glViewport(0, 0, texels, tile.size.y);
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        this->packShader.setIVec2("gridSize", tile.size);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        // with a pack buffer bound glReadPixels only queues the copy and returns immediately
+        const size_t offset = (size_t(tile.origin.y) * this->packWidth + tile.origin.x / 32) * sizeof(GLuint);
+        glReadPixels(0, 0, texels, tile.size.y, GL_RED_INTEGER, GL_UNSIGNED_INT, reinterpret_cast<void*>(offset));
+    }
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.generation = generation;
+    slot.edited = edited;
+    this->readbackCount++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+bool SimulationShader::PollStateReadback(uint64_t& generation, bool& edited, BitGrid& grid, bool wait) {
+    if (this->readbackCount == 0) {
+        return false;
+    }
+    Readback& slot = this->readbacks[this->readbackHead];
+
+    const GLuint64 timeout = wait ? GLuint64(1000000000) : 0;
+    const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    this->readbackHead = (this->readbackHead + 1) % READBACK_SLOTS;
+    this->readbackCount--;
+    if (status == GL_WAIT_FAILED) {
+        return false;
+    }
+
+    if (grid.Width() != this->simWidth || grid.Height() != this->simHeight) {
+        grid.Resize(this->simWidth, this->simHeight);
+    }
+
+    // the pack texture rows are exactly BitGrid rows (two 32-bit texels per 64-bit word)
+    const size_t bytes = grid.Words().size() * sizeof(uint64_t);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(grid.Words().data(), data, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    generation = slot.generation;
+    edited = slot.edited;
+    return data != nullptr;
+}
+
+bool SimulationShader::RequestStats(uint64_t generation) {
+    if (!this->statsFBO) {
+        createStatsResources();
+    }
+    if (this->statsCount == STATS_SLOTS) {
+        return false;
+    }
+    TRACE_ZONE("SimulationShader::RequestStats");
+    Readback& slot = this->statsSlots[(this->statsHead + this->statsCount) % STATS_SLOTS];
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->statsFBO);
+    this->statsShader.use();
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    // all count texels first, then all bounds texels, tile after tile
+    const size_t texelBytes = 4 * sizeof(GLint);
+    size_t offset = 0;
+    for (const Tile& tile : this->tiles) {
+        const GLsizei blocksX = GLsizei((tile.size.x + STATS_BLOCK - 1) / STATS_BLOCK);
+        const GLsizei blocksY = GLsizei((tile.size.y + STATS_BLOCK - 1) / STATS_BLOCK);
+        glViewport(0, 0, blocksX, blocksY);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current ^ 1]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        this->statsShader.setIVec2("tileSize", tile.size);
+        this->statsShader.setIVec2("tileOrigin", tile.origin);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        for (size_t plane = 0; plane < 2; plane++) {
+            glReadBuffer(GLenum(GL_COLOR_ATTACHMENT0 + plane));
+            const size_t planeOffset = (plane * this->statsBlocks + offset) * texelBytes;
+            glReadPixels(0, 0, blocksX, blocksY, GL_RGBA_INTEGER, GL_INT, reinterpret_cast<void*>(planeOffset));
+        }
+        offset += size_t(blocksX) * blocksY;
+    }
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.generation = generation;
+    this->statsCount++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+bool SimulationShader::PollStats(uint64_t& generation, BoardStats& stats, bool wait) {
+    if (this->statsCount == 0) {
+        return false;
+    }
+    Readback& slot = this->statsSlots[this->statsHead];
+
+    const GLuint64 timeout = wait ? GLuint64(1000000000) : 0;
+    const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    this->statsHead = (this->statsHead + 1) % STATS_SLOTS;
+    this->statsCount--;
+    if (status == GL_WAIT_FAILED) {
+        return false;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    const GLint* data = static_cast<const GLint*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+        2 * this->statsBlocks * 4 * sizeof(GLint), GL_MAP_READ_BIT));
+    if (data) {
+        stats = BoardStats();
+        const GLint* bounds = data + this->statsBlocks * 4;
+        for (size_t block = 0; block < this->statsBlocks; block++) {
+            BoardStats part;
+            part.population = uint64_t(data[block * 4]);
+            part.births = uint64_t(data[block * 4 + 1]);
+            part.deaths = uint64_t(data[block * 4 + 2]);
+            if (part.population > 0) {
+                part.minX = uint32_t(bounds[block * 4]);
+                part.minY = uint32_t(bounds[block * 4 + 1]);
+                part.maxX = uint32_t(bounds[block * 4 + 2]);
+                part.maxY = uint32_t(bounds[block * 4 + 3]);
+            }
+            stats.Merge(part);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    generation = slot.generation;
+    return data != nullptr;
+}
+
 void SimulationShader::createSimulationQuad() {
 	glGenVertexArrays(1, &this->VAO);
 	glGenBuffers(1, &this->VBO);
@@ -107,23 +385,204 @@ void SimulationShader::createSimulationQuad() {
     glBindVertexArray(0);
 }
 
-void SimulationShader::createTexture() {
-    // Create the frame buffer for the simulation
-    glGenFramebuffers(1, &this->FBO);
+void SimulationShader::createTiles() {
+    this->tilesX = (this->simWidth + this->tileSize - 1) / this->tileSize;
+    this->tilesY = (this->simHeight + this->tileSize - 1) / this->tileSize;
+    this->tiles.resize(this->tilesX * this->tilesY);
+
+    for (size_t tileY = 0; tileY < this->tilesY; tileY++) {
+        for (size_t tileX = 0; tileX < this->tilesX; tileX++) {
+            Tile& tile = this->tiles[tileY * this->tilesX + tileX];
+            tile.origin = glm::ivec2(tileX * this->tileSize, tileY * this->tileSize);
+            tile.size = glm::ivec2(std::min(this->tileSize, this->simWidth - tile.origin.x), std::min(this->tileSize, this->simHeight - tile.origin.y));
+
+            glGenTextures(2, tile.textures);
+            glGenFramebuffers(2, tile.FBOs);
+            if (this->trackAge) {
+                glGenTextures(2, tile.ages);
+            }
+            for (size_t i = 0; i < 2; i++) {
+                // one byte per cell; the mip chain is only filled in when drawing zoomed out
+                glBindTexture(GL_TEXTURE_2D, tile.textures[i]);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, tile.size.x + 2, tile.size.y + 2, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+                // with a dead boundary the halos on the board's edges are never written and must read as dead
+                glBindFramebuffer(GL_FRAMEBUFFER, tile.FBOs[i]);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tile.textures[i], 0);
+                if (this->trackAge) {
+                    // ages are only read at the cell itself, so they need no halo exchange
+                    glBindTexture(GL_TEXTURE_2D, tile.ages[i]);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, tile.size.x + 2, tile.size.y + 2, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, tile.ages[i], 0);
+                    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+                    glDrawBuffers(2, drawBuffers);
+                }
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+        }
+    }
+
+    if (this->boundary == Boundary::Klein) {
+        glGenFramebuffers(1, &this->haloFBO);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void SimulationShader::exchangeHalos() {
+    if (this->tiles.size() == 1 && this->boundary == Boundary::Dead) {
+        return;
+    }
+    TRACE_ZONE("SimulationShader::exchangeHalos");
 
-    // Generate the texture the simulation will use
-    glGenTextures(1, &this->texture);
+    const int64_t boardWidth = int64_t(this->simWidth), boardHeight = int64_t(this->simHeight);
+    // interior rows/columns start at 1; the halo is at 0 and size + 1
+    for (const Tile& tile : this->tiles) {
+        glBindTexture(GL_TEXTURE_2D, tile.textures[this->current]);
+        if (this->boundary == Boundary::Klein) {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->haloFBO);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tile.textures[this->current], 0);
+        }
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) {
+                    continue;
+                }
+                // an edge strip for direct neighbours, a single cell for diagonal ones
+                const GLint targetX = dx < 0 ? 0 : dx == 0 ? 1 : tile.size.x + 1;
+                const GLint targetY = dy < 0 ? 0 : dy == 0 ? 1 : tile.size.y + 1;
+                const int64_t width = dx == 0 ? tile.size.x : 1;
+                const int64_t height = dy == 0 ? tile.size.y : 1;
+                int64_t x = tile.origin.x + targetX - 1, y = tile.origin.y + targetY - 1;
 
-    // Configure the texture
-    glBindTexture(GL_TEXTURE_2D, this->texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, this->simWidth, this->simHeight, 0, GL_RED, GL_FLOAT, nullptr);
+                // board cells beyond an edge come from where the boundary puts them
+                const bool outsideX = x < 0 || x >= boardWidth, outsideY = y < 0 || y >= boardHeight;
+                bool mirrored = false;
+                if ((outsideX || outsideY) && this->boundary == Boundary::Dead) {
+                    continue;
+                }
+                if (this->boundary == Boundary::Mirror) {
+                    x = std::clamp<int64_t>(x, 0, boardWidth - 1);
+                    y = std::clamp<int64_t>(y, 0, boardHeight - 1);
+                }
+                else {
+                    x = (x + boardWidth) % boardWidth;
+                    y = (y + boardHeight) % boardHeight;
+                    if (outsideY && this->boundary == Boundary::Klein) {
+                        x = boardWidth - x - width;
+                        mirrored = true;
+                    }
+                }
+                copyHaloCells(targetX, targetY, size_t(x), size_t(y), size_t(width), size_t(height), mirrored);
+            }
+        }
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void SimulationShader::copyHaloCells(GLint targetX, GLint targetY, size_t x, size_t y, size_t width, size_t height, bool mirrored) {
+    // the cells may span several tiles, e.g. a mirrored strip of a board that is not a whole number of tiles wide
+    for (size_t top = y; top < y + height;) {
+        const size_t tileY = top / this->tileSize;
+        const size_t rows = std::min(y + height, (tileY + 1) * this->tileSize) - top;
+        for (size_t left = x; left < x + width;) {
+            const size_t tileX = left / this->tileSize;
+            const size_t columns = std::min(x + width, (tileX + 1) * this->tileSize) - left;
+            const Tile& source = this->tiles[tileY * this->tilesX + tileX];
+            const GLint sourceX = GLint(left - source.origin.x + 1), sourceY = GLint(top - source.origin.y + 1);
+            const GLint destinationY = targetY + GLint(top - y);
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, source.FBOs[this->current]);
+            if (mirrored) {
+                // cell x + i lands at width - 1 - i; a blit from right to left reverses the columns
+                const GLint destinationX = targetX + GLint(x + width - left - columns);
+                glBlitFramebuffer(sourceX + GLint(columns), sourceY, sourceX, sourceY + GLint(rows),
+                    destinationX, destinationY, destinationX + GLint(columns), destinationY + GLint(rows), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            }
+            else {
+                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, targetX + GLint(left - x), destinationY, sourceX, sourceY, GLsizei(columns), GLsizei(rows));
+            }
+            left += columns;
+        }
+        top += rows;
+    }
+}
+
+void SimulationShader::createReadbackResources() {
+    this->packShader.use();
+    this->packShader.setInt("currentState", 0);
+
+    // two 32-bit texels per 64-bit BitGrid word
+    this->packWidth = ((this->simWidth + 63) / 64) * 2;
+
+    // tiles are packed one after another through a texture the size of the largest one
+    const Tile& largest = this->tiles[0];
+    glGenTextures(1, &this->packTexture);
+    glBindTexture(GL_TEXTURE_2D, this->packTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, (largest.size.x + 63) / 64 * 2, largest.size.y, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    // Attach the texture to the simulation FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->texture, 0);
+    glGenFramebuffers(1, &this->packFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->packFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->packTexture, 0);
+
+    const size_t bytes = this->packWidth * this->simHeight * sizeof(GLuint);
+    for (Readback& slot : this->readbacks) {
+        glGenBuffers(1, &slot.PBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void SimulationShader::createStatsResources() {
+    this->statsShader.use();
+    this->statsShader.setInt("currentState", 0);
+    this->statsShader.setInt("previousState", 1);
+
+    this->statsBlocks = 0;
+    for (const Tile& tile : this->tiles) {
+        this->statsBlocks += ((tile.size.x + STATS_BLOCK - 1) / STATS_BLOCK) * ((tile.size.y + STATS_BLOCK - 1) / STATS_BLOCK);
+    }
+
+    // tiles are reduced one after another through textures the size of the largest one
+    const Tile& largest = this->tiles[0];
+    glGenFramebuffers(1, &this->statsFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->statsFBO);
+    glGenTextures(2, this->statsTextures);
+    for (size_t plane = 0; plane < 2; plane++) {
+        glBindTexture(GL_TEXTURE_2D, this->statsTextures[plane]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32I, GLsizei((largest.size.x + STATS_BLOCK - 1) / STATS_BLOCK),
+            GLsizei((largest.size.y + STATS_BLOCK - 1) / STATS_BLOCK), 0, GL_RGBA_INTEGER, GL_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GLenum(GL_COLOR_ATTACHMENT0 + plane), GL_TEXTURE_2D, this->statsTextures[plane], 0);
+    }
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    const size_t bytes = 2 * this->statsBlocks * 4 * sizeof(GLint);
+    for (Readback& slot : this->statsSlots) {
+        glGenBuffers(1, &slot.PBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
 
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
\ No newline at end of file
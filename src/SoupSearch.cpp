@@ -0,0 +1,615 @@
+#include "SoupSearch.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <BitGrid.h>
+#include <BoardHash.h>
+#include <CycleDetector.h>
+#include <DirtyTiles.h>
+#include <LifeRule.h>
+#include <ObjectLabeler.h>
+#include <Pattern.h>
+#include <PatternStore.h>
+#include <RandomGenerator.h>
+#include <SmallBoard.h>
+#include <Trace.h>
+
+namespace {
+    const size_t SOUP_SIZE = 16;
+    const size_t BOARD_SIZE = 256;
+    // objects with a cell this close to the edge are removed as escapees before the dead
+    // boundary ring can turn them into debris
+    const size_t ESCAPE_MARGIN = 8;
+    // natural objects move at most c/2, so they cross at most 2 cells of the margin in between
+    const uint64_t ESCAPE_CHECK_INTERVAL = 4;
+    const uint64_t MAX_GENERATIONS = 50000;
+    // soups a worker takes at a time
+    const uint64_t SOUP_BATCH = 64;
+    // room around an object that is run on its own to find its period
+    const size_t ISOLATION_PADDING = 4;
+    // objects are classified by shape up to this size, larger ones are only counted
+    const size_t MAX_OBJECT_SIZE = Pattern::MAX_SIZE;
+    // soups start on small boards, and objects whose isolation box fits one (almost all) are
+    // run on them to find their period, LANES at a time
+    using SmallBoards = SmallBoardBatch<64, 64, 8>;
+    // a soup moves to the full board once it comes this close to the edge of its small board,
+    // where the dead ring would start to make a difference, or after this many generations
+    const size_t SMALL_BOARD_MARGIN = 2;
+    const uint64_t SMALL_BOARD_GENERATIONS = 256;
+    const size_t CENSUS_LINES = 40;
+
+    struct Cell {
+        uint32_t x, y;
+    };
+
+    // what an object was classified as; only turned into text for the report
+    struct ObjectKey {
+        enum class Kind : uint32_t { StillLife, Oscillator, Unsettled, Oversized, Glider, Escaped };
+
+        Kind kind = Kind::Escaped;
+        uint64_t value = 0;     // population of still lifes and unsettled objects, period of oscillators
+        uint64_t pattern = 0;   // PatternStore key of still lifes and oscillators
+
+        bool operator==(const ObjectKey& other) const {
+            return this->kind == other.kind && this->value == other.value && this->pattern == other.pattern;
+        }
+    };
+
+    struct ObjectKeyHash {
+        size_t operator()(const ObjectKey& key) const {
+            // pattern is a hash already
+            return size_t(key.pattern ^ (key.value * 0x9E3779B97F4A7C15ull) ^ uint64_t(key.kind));
+        }
+    };
+
+    // objects found and soups run by one worker, added up at the end
+    struct Census {
+        std::unordered_map<ObjectKey, uint64_t, ObjectKeyHash> objects;
+        PatternStore patterns;      // the shapes of the still lifes and oscillators in objects
+        uint64_t soups = 0;
+        uint64_t unsettled = 0;     // soups still changing after MAX_GENERATIONS
+        uint64_t generations = 0;
+
+        void Merge(const Census& other) {
+            for (const auto& [key, count] : other.objects) {
+                this->objects[key] += count;
+            }
+            for (const auto& entry : other.patterns.Patterns()) {
+                this->patterns.AddCanonical(entry.second);
+            }
+            this->soups += other.soups;
+            this->unsettled += other.unsettled;
+            this->generations += other.generations;
+        }
+    };
+
+    // well-known objects, for readable census lines
+    struct NamedObject {
+        const char* name;
+        std::vector<const char*> rows;  // top to bottom, '*' alive
+    };
+
+    const std::vector<NamedObject> NAMED_OBJECTS = {
+        { "block", { "**", "**" } },
+        { "beehive", { ".**.", "*..*", ".**." } },
+        { "loaf", { ".**.", "*..*", ".*.*", "..*." } },
+        { "boat", { "**.", "*.*", ".*." } },
+        { "tub", { ".*.", "*.*", ".*." } },
+        { "ship", { "**.", "*.*", ".**" } },
+        { "pond", { ".**.", "*..*", "*..*", ".**." } },
+        { "long boat", { "**..", "*.*.", ".*.*", "..*." } },
+        { "barge", { ".*..", "*.*.", ".*.*", "..*." } },
+        { "mango", { ".**..", "*..*.", ".*..*", "..**." } },
+        { "blinker", { "***" } },
+        { "toad", { ".***", "***." } },
+        { "beacon", { "**..", "**..", "..**", "..**" } },
+    };
+
+    const char* GLIDER_ROWS[] = { ".*.", "..*", "***" };
+
+    uint64_t soupSeed(uint64_t seed, uint64_t index) {
+        // splitmix64, so neighbouring indices give unrelated generators
+        uint64_t x = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // the live cells 8-connected to (x, y), which are cleared from cells; cheaper than labelling
+    // the whole board when only the few objects near the edge are wanted
+    void takeComponent(BitGrid& cells, size_t x, size_t y, std::vector<Cell>& component) {
+        component.clear();
+        component.push_back({ uint32_t(x), uint32_t(y) });
+        cells.Set(x, y, false);
+        for (size_t i = 0; i < component.size(); i++) {
+            const Cell cell = component[i];
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const int64_t nx = int64_t(cell.x) + dx, ny = int64_t(cell.y) + dy;
+                    if (nx < 0 || ny < 0 || nx >= int64_t(cells.Width()) || ny >= int64_t(cells.Height()) || !cells.Get(nx, ny)) {
+                        continue;
+                    }
+                    cells.Set(nx, ny, false);
+                    component.push_back({ uint32_t(nx), uint32_t(ny) });
+                }
+            }
+        }
+    }
+
+    // Runs the object on its own for up to maxPeriod generations. Still lifes and oscillators
+    // are keyed by the smallest canonical pattern over all phases, which is added to patterns;
+    // objects that do not repeat on their own (they lean on a neighbour) are Unsettled.
+    ObjectKey classify(const std::vector<Cell>& envelope, const BitGrid& board, uint64_t maxPeriod, PatternStore& patterns) {
+        uint32_t minX = envelope[0].x, minY = envelope[0].y, maxX = minX, maxY = minY;
+        for (const Cell& cell : envelope) {
+            minX = std::min(minX, cell.x);
+            minY = std::min(minY, cell.y);
+            maxX = std::max(maxX, cell.x);
+            maxY = std::max(maxY, cell.y);
+        }
+        if (maxX - minX + 1 > MAX_OBJECT_SIZE || maxY - minY + 1 > MAX_OBJECT_SIZE) {
+            return { ObjectKey::Kind::Oversized };
+        }
+
+        BitGrid isolated(maxX - minX + 1 + 2 * ISOLATION_PADDING, maxY - minY + 1 + 2 * ISOLATION_PADDING);
+        uint64_t population = 0;
+        for (const Cell& cell : envelope) {
+            if (board.Get(cell.x, cell.y)) {
+                isolated.Set(cell.x - minX + ISOLATION_PADDING, cell.y - minY + ISOLATION_PADDING, true);
+                population++;
+            }
+        }
+
+        const BitGrid start = isolated;
+        BitGrid next;
+        Pattern best, phase;
+        Pattern::FromGrid(isolated, phase);
+        best = phase.Canonical();
+        uint64_t period = 0;
+        for (uint64_t t = 1; t <= maxPeriod; t++) {
+            LifeRule::Step(isolated, next);
+            std::swap(isolated, next);
+            if (isolated == start) {
+                period = t;
+                break;
+            }
+            if (!Pattern::FromGrid(isolated, phase)) {
+                return { ObjectKey::Kind::Oversized };
+            }
+            Pattern candidate = phase.Canonical();
+            if (candidate < best) {
+                best = std::move(candidate);
+            }
+        }
+        if (period == 0) {
+            return { ObjectKey::Kind::Unsettled, population };
+        }
+        const uint64_t pattern = patterns.AddCanonical(best);
+        return period == 1 ? ObjectKey{ ObjectKey::Kind::StillLife, population, pattern } : ObjectKey{ ObjectKey::Kind::Oscillator, period, pattern };
+    }
+
+    // "xs<population>_<code>", "xp<period>_<code>", "xx<population>" or the kind
+    std::string describe(const ObjectKey& key, const PatternStore& patterns) {
+        const Pattern* pattern = patterns.Find(key.pattern);
+        switch (key.kind) {
+        case ObjectKey::Kind::StillLife:
+            return "xs" + std::to_string(key.value) + "_" + (pattern ? pattern->Code() : "?");
+        case ObjectKey::Kind::Oscillator:
+            return "xp" + std::to_string(key.value) + "_" + (pattern ? pattern->Code() : "?");
+        case ObjectKey::Kind::Unsettled:
+            return "xx" + std::to_string(key.value);
+        case ObjectKey::Kind::Oversized:
+            return "oversized";
+        case ObjectKey::Kind::Glider:
+            return "glider";
+        case ObjectKey::Kind::Escaped:
+            break;
+        }
+        return "escaped";
+    }
+
+    class SoupRunner
+    {
+    public:
+        // objectDistance: see ObjectLabeler
+        SoupRunner(const std::vector<uint64_t>& gliderKeys, unsigned objectDistance)
+            : gliderKeys(gliderKeys), labeler(objectDistance, 1) {
+            this->grid.Resize(BOARD_SIZE, BOARD_SIZE);
+            // the columns of the margin, for the rows between its top and bottom parts
+            this->marginColumns.assign(this->grid.WordsPerRow(), 0);
+            for (size_t x = 0; x < BOARD_SIZE; x++) {
+                if (x < ESCAPE_MARGIN || x >= BOARD_SIZE - ESCAPE_MARGIN) {
+                    this->marginColumns[x / 64] |= 1ull << (x % 64);
+                }
+            }
+        }
+
+        // runs the soups first to first + count - 1, at most SmallBoards::LANES
+        void Run(uint64_t seed, uint64_t first, size_t count, Census& census) {
+            std::array<uint64_t, SmallBoards::LANES> generations{};
+            startSoups(seed, first, count, generations);
+            for (size_t lane = 0; lane < count; lane++) {
+                finishSoup(lane, generations[lane], census);
+            }
+        }
+
+    private:
+        const std::vector<uint64_t>& gliderKeys;
+        BitGrid grid, next, envelope, phase;
+        DirtyTiles changed;
+        CycleDetector cycles;
+        std::vector<Cell> component;
+        std::vector<uint64_t> marginColumns;
+        ObjectLabeler labeler;
+        std::vector<std::vector<Cell>> objectCells;
+        SmallBoards soups[2], parked;
+        SmallBoards isolated[2], isolatedStart;
+        Pattern isolatedPhase;
+        std::array<Pattern, SmallBoards::LANES> best;
+
+        // Runs the soups together on small boards while they stay clear of the edge, which
+        // matches the full board exactly and costs a fraction of a step of it. Each soup is
+        // parked in its lane of parked at the generation it leaves, which goes to generations.
+        void startSoups(uint64_t seed, uint64_t first, size_t count, std::array<uint64_t, SmallBoards::LANES>& generations) {
+            this->soups[0].Clear();
+            const size_t corner = (BOARD_SIZE - SOUP_SIZE) / 2, smallCorner = (SmallBoards::WIDTH - SOUP_SIZE) / 2;
+            for (size_t lane = 0; lane < count; lane++) {
+                // drawn on the full board, so the soups do not depend on where they start
+                this->grid.Clear();
+                RandomGenerator rng(soupSeed(seed, first + lane));
+                rng.fillRectWithNoise(this->grid, corner, corner, SOUP_SIZE, SOUP_SIZE);
+                for (size_t y = 0; y < SOUP_SIZE; y++) {
+                    for (size_t x = 0; x < SOUP_SIZE; x++) {
+                        this->soups[0].Set(lane, smallCorner + x, smallCorner + y, this->grid.Get(corner + x, corner + y));
+                    }
+                }
+            }
+
+            SmallBoards* current = &this->soups[0];
+            SmallBoards* next = &this->soups[1];
+            size_t running = count;
+            for (uint64_t generation = 1; generation <= SMALL_BOARD_GENERATIONS && running > 0; generation++) {
+                current->Step(*next);
+                std::swap(current, next);
+                for (size_t lane = 0; lane < count; lane++) {
+                    if (generations[lane] != 0) {
+                        continue;
+                    }
+                    // the cells next to the ring were born from cells inside it, so are still exact
+                    if (generation == SMALL_BOARD_GENERATIONS || !current->Within(lane, SMALL_BOARD_MARGIN)) {
+                        this->parked.CopyLane(lane, *current, lane);
+                        generations[lane] = generation;
+                        running--;
+                    }
+                }
+            }
+        }
+
+        // runs the soup parked in lane at generation on the full board until it settles, and
+        // adds what it leaves to census
+        void finishSoup(size_t lane, uint64_t generation, Census& census) {
+            this->grid.Clear();
+            const size_t offset = (BOARD_SIZE - SmallBoards::WIDTH) / 2, word = offset / 64, shift = offset % 64;
+            for (size_t y = 0; y < SmallBoards::HEIGHT; y++) {
+                const uint64_t row = this->parked.Row(lane, y);
+                uint64_t* out = this->grid.Row(offset + y) + word;
+                out[0] |= row << shift;
+                if (shift != 0) {
+                    out[1] |= row >> (64 - shift);
+                }
+            }
+
+            uint64_t hash = BoardHash::Full(this->grid);
+            this->cycles.Reset();
+            this->cycles.Observe(generation, hash, this->grid);
+            census.soups++;
+
+            bool settled = false;
+            while (generation < MAX_GENERATIONS) {
+                LifeRule::Step(this->grid, this->next, this->changed, hash);
+                std::swap(this->grid, this->next);
+                generation++;
+                if (generation % ESCAPE_CHECK_INTERVAL == 0 && removeEscapees(census)) {
+                    // a new board as far as the cycle search is concerned
+                    hash = BoardHash::Full(this->grid);
+                    this->cycles.Reset();
+                }
+                if (this->cycles.Observe(generation, hash, this->grid)) {
+                    settled = true;
+                    break;
+                }
+            }
+            census.generations += generation;
+            if (!settled) {
+                census.unsettled++;
+                return;
+            }
+
+            // objects are separated on the cells that are alive in any phase, so an oscillator
+            // whose phases fall apart (a beacon) stays one object
+            const uint64_t period = this->cycles.Period();
+            this->envelope = this->grid;
+            this->phase = this->grid;
+            for (uint64_t t = 1; t < period; t++) {
+                LifeRule::Step(this->phase, this->next);
+                std::swap(this->phase, this->next);
+                for (size_t i = 0; i < this->envelope.Words().size(); i++) {
+                    this->envelope.Words()[i] |= this->phase.Words()[i];
+                }
+            }
+            const std::vector<LabeledObject>& boxes = this->labeler.Label(this->envelope);
+            const size_t objects = boxes.size();
+            if (this->objectCells.size() < objects) {
+                this->objectCells.resize(objects);
+            }
+            for (size_t object = 0; object < objects; object++) {
+                this->objectCells[object].clear();
+            }
+            for (const ObjectLabeler::Run& run : this->labeler.Runs()) {
+                for (uint32_t x = run.start; x <= run.end; x++) {
+                    this->objectCells[run.object].push_back({ x, run.y });
+                }
+            }
+            size_t lanes = 0;
+            this->isolated[0].Clear();
+            for (size_t object = 0; object < objects; object++) {
+                const LabeledObject& box = boxes[object];
+                if (box.maxX - box.minX + 1 + 2 * ISOLATION_PADDING > SmallBoards::WIDTH ||
+                    box.maxY - box.minY + 1 + 2 * ISOLATION_PADDING > SmallBoards::HEIGHT) {
+                    census.objects[classify(this->objectCells[object], this->grid, period, census.patterns)]++;
+                    continue;
+                }
+                for (const Cell& cell : this->objectCells[object]) {
+                    if (this->grid.Get(cell.x, cell.y)) {
+                        this->isolated[0].Set(lanes, cell.x - box.minX + ISOLATION_PADDING, cell.y - box.minY + ISOLATION_PADDING, true);
+                    }
+                }
+                if (++lanes == SmallBoards::LANES) {
+                    classifyIsolated(lanes, period, census);
+                    lanes = 0;
+                    this->isolated[0].Clear();
+                }
+            }
+            if (lanes > 0) {
+                classifyIsolated(lanes, period, census);
+            }
+        }
+
+        // classify for the objects in the first lanes of isolated[0], all run at once
+        void classifyIsolated(size_t lanes, uint64_t maxPeriod, Census& census) {
+            this->isolatedStart = this->isolated[0];
+            std::array<uint64_t, SmallBoards::LANES> periods{};
+            for (size_t lane = 0; lane < lanes; lane++) {
+                Pattern::FromRows(this->isolated[0].Lane(lane), SmallBoards::HEIGHT, SmallBoards::LANES, this->isolatedPhase);
+                this->best[lane] = this->isolatedPhase.Canonical();
+            }
+            SmallBoards* current = &this->isolated[0];
+            SmallBoards* next = &this->isolated[1];
+            size_t open = lanes;
+            for (uint64_t t = 1; t <= maxPeriod && open > 0; t++) {
+                current->Step(*next);
+                std::swap(current, next);
+                for (size_t lane = 0; lane < lanes; lane++) {
+                    if (periods[lane] != 0) {
+                        continue;
+                    }
+                    if (current->SameBoard(lane, this->isolatedStart, lane)) {
+                        periods[lane] = t;
+                        open--;
+                        continue;
+                    }
+                    Pattern::FromRows(current->Lane(lane), SmallBoards::HEIGHT, SmallBoards::LANES, this->isolatedPhase);
+                    Pattern candidate = this->isolatedPhase.Canonical();
+                    if (candidate < this->best[lane]) {
+                        this->best[lane] = std::move(candidate);
+                    }
+                }
+            }
+            for (size_t lane = 0; lane < lanes; lane++) {
+                const uint64_t population = this->isolatedStart.Population(lane);
+                if (periods[lane] == 0) {
+                    census.objects[{ ObjectKey::Kind::Unsettled, population }]++;
+                    continue;
+                }
+                const uint64_t pattern = census.patterns.AddCanonical(this->best[lane]);
+                census.objects[periods[lane] == 1 ? ObjectKey{ ObjectKey::Kind::StillLife, population, pattern }
+                    : ObjectKey{ ObjectKey::Kind::Oscillator, periods[lane], pattern }]++;
+            }
+        }
+
+        // removes every object with a cell in the margin; gliders are counted as such
+        bool removeEscapees(Census& census) {
+            bool removed = false;
+            for (size_t y = 0; y < BOARD_SIZE; y++) {
+                const bool marginRow = y < ESCAPE_MARGIN || y >= BOARD_SIZE - ESCAPE_MARGIN;
+                const uint64_t* row = this->grid.Row(y);
+                for (size_t i = 0; i < this->grid.WordsPerRow(); i++) {
+                    uint64_t word = row[i] & (marginRow ? ~0ull : this->marginColumns[i]);
+                    while (word != 0) {
+                        const size_t x = i * 64 + size_t(std::countr_zero(word));
+                        word &= word - 1;
+                        // an earlier object may have taken this cell along
+                        if (!this->grid.Get(x, y)) {
+                            continue;
+                        }
+                        takeComponent(this->grid, x, y, this->component);
+                        census.objects[classifyEscapee()]++;
+                        removed = true;
+                    }
+                }
+            }
+            return removed;
+        }
+
+        ObjectKey classifyEscapee() {
+            // cropped straight from the cells; a glider has 5
+            uint32_t minX = this->component[0].x, minY = this->component[0].y, maxX = minX, maxY = minY;
+            for (const Cell& cell : this->component) {
+                minX = std::min(minX, cell.x);
+                minY = std::min(minY, cell.y);
+                maxX = std::max(maxX, cell.x);
+                maxY = std::max(maxY, cell.y);
+            }
+            if (maxX - minX + 1 > MAX_OBJECT_SIZE || maxY - minY + 1 > MAX_OBJECT_SIZE) {
+                return { ObjectKey::Kind::Escaped };
+            }
+            Pattern pattern;
+            pattern.width = maxX - minX + 1;
+            pattern.height = maxY - minY + 1;
+            pattern.rows.assign(pattern.height, 0);
+            for (const Cell& cell : this->component) {
+                pattern.rows[cell.y - minY] |= 1ull << (cell.x - minX);
+            }
+            const uint64_t key = pattern.Canonical().Hash();
+            const bool glider = std::find(this->gliderKeys.begin(), this->gliderKeys.end(), key) != this->gliderKeys.end();
+            return { glider ? ObjectKey::Kind::Glider : ObjectKey::Kind::Escaped };
+        }
+    };
+
+    using ObjectNames = std::unordered_map<ObjectKey, std::string, ObjectKeyHash>;
+
+    void printCensus(const Census& census, const ObjectNames& names) {
+        std::vector<std::tuple<std::string, uint64_t, ObjectKey>> sorted;
+        for (const auto& [key, count] : census.objects) {
+            sorted.emplace_back(describe(key, census.patterns), count, key);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return std::get<1>(a) != std::get<1>(b) ? std::get<1>(a) > std::get<1>(b) : std::get<0>(a) < std::get<0>(b);
+        });
+        uint64_t total = 0;
+        for (const auto& entry : census.objects) {
+            total += entry.second;
+        }
+        std::printf("  objects     %llu in %zu kinds\n", (unsigned long long)total, sorted.size());
+        for (size_t i = 0; i < sorted.size() && i < CENSUS_LINES; i++) {
+            const auto& [code, count, key] = sorted[i];
+            const auto name = names.find(key);
+            std::printf("  %12llu  %-10s %s\n", (unsigned long long)count, name != names.end() ? name->second.c_str() : "", code.c_str());
+        }
+        if (sorted.size() > CENSUS_LINES) {
+            std::printf("  ... %zu more kinds\n", sorted.size() - CENSUS_LINES);
+        }
+    }
+
+    bool writeCensus(const std::string& path, const Census& census, const ObjectNames& names) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            std::printf("ERROR::SOUP_SEARCH::CANNOT_WRITE_CENSUS(%s)\n", path.c_str());
+            return false;
+        }
+        file << "object,name,count\n";
+        for (const auto& [key, count] : census.objects) {
+            const auto name = names.find(key);
+            file << describe(key, census.patterns) << "," << (name != names.end() ? name->second : "") << "," << count << "\n";
+        }
+        return bool(file);
+    }
+}
+
+int RunSoupSearch(const AppConfig& config) {
+    const uint64_t soups = config.soupCount;
+    const uint64_t seed = config.seed ? config.seed : 1;
+    const unsigned threads = config.soupThreads ? config.soupThreads : std::max(1u, std::thread::hardware_concurrency());
+
+    // the keys the classifier gives the named objects, in a phase they are not usually seen in
+    ObjectNames names;
+    PatternStore namedPatterns;
+    for (const NamedObject& object : NAMED_OBJECTS) {
+        const size_t width = std::string(object.rows[0]).size(), height = object.rows.size();
+        BitGrid board(width, height);
+        std::vector<Cell> cells;
+        for (size_t y = 0; y < height; y++) {
+            for (size_t x = 0; x < width; x++) {
+                cells.push_back({ uint32_t(x), uint32_t(y) });
+                board.Set(x, y, object.rows[height - 1 - y][x] == '*');
+            }
+        }
+        names[classify(cells, board, 2, namedPatterns)] = object.name;
+    }
+    // escapees are matched in whatever phase they were caught
+    std::vector<uint64_t> gliderKeys;
+    {
+        BitGrid glider(8, 8), next;
+        for (size_t y = 0; y < 3; y++) {
+            for (size_t x = 0; x < 3; x++) {
+                glider.Set(x + 2, y + 2, GLIDER_ROWS[2 - y][x] == '*');
+            }
+        }
+        for (int phase = 0; phase < 4; phase++) {
+            Pattern pattern;
+            Pattern::FromGrid(glider, pattern);
+            gliderKeys.push_back(pattern.Canonical().Hash());
+            LifeRule::Step(glider, next);
+            std::swap(glider, next);
+        }
+    }
+
+    std::printf("Soup search: %llu soups of %zux%zu on %zux%zu boards, seed %llu, %u threads\n", (unsigned long long)soups,
+        SOUP_SIZE, SOUP_SIZE, BOARD_SIZE, BOARD_SIZE, (unsigned long long)seed, threads);
+
+    std::atomic<uint64_t> nextSoup{ 0 };
+    std::vector<Census> censuses(threads);
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            Trace::SetThreadName("soup search");
+            SoupRunner runner(gliderKeys, config.objectDistance);
+            while (true) {
+                const uint64_t first = nextSoup.fetch_add(SOUP_BATCH, std::memory_order_relaxed);
+                if (first >= soups) {
+                    break;
+                }
+                TRACE_ZONE("soup batch");
+                const uint64_t last = std::min(first + SOUP_BATCH, soups);
+                for (uint64_t index = first; index < last; index += SmallBoards::LANES) {
+                    runner.Run(seed, index, size_t(std::min<uint64_t>(SmallBoards::LANES, last - index)), censuses[t]);
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Census census;
+    for (const Census& part : censuses) {
+        census.Merge(part);
+    }
+
+    std::printf("  time        %.3f s\n", seconds);
+    if (seconds > 0.0) {
+        std::printf("  throughput  %.1f soups/s (%.1f per thread), %.0f generations/s\n", double(census.soups) / seconds,
+            double(census.soups) / seconds / threads, double(census.generations) / seconds);
+    }
+    if (census.unsettled > 0) {
+        std::printf("  unsettled   %llu soups still changing after %llu generations\n", (unsigned long long)census.unsettled,
+            (unsigned long long)MAX_GENERATIONS);
+    }
+    printCensus(census, names);
+
+    if (!config.censusPath.empty() && !writeCensus(config.censusPath, census, names)) {
+        return -1;
+    }
+    if (!config.patternStorePath.empty()) {
+        PatternStore store(config.patternStorePath);
+        for (const auto& entry : census.patterns.Patterns()) {
+            store.AddCanonical(entry.second);
+        }
+        std::printf("Pattern store: %zu patterns, %zu new, in %s\n", store.Size(), store.Added(), config.patternStorePath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "StatsWriter.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const char STATS_MAGIC[8] = { 'G', 'O', 'L', 'S', 'T', 'A', 'T', '1' };
+
+    struct StatsRecord {
+        uint64_t generation;
+        uint64_t population;
+        uint64_t births;
+        uint64_t deaths;
+        uint32_t minX, minY, maxX, maxY;
+    };
+    static_assert(sizeof(StatsRecord) == 48, "stats records are written as is");
+
+    bool endsWith(const std::string& text, const char* suffix) {
+        const size_t length = std::strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+}
+
+StatsWriter::StatsWriter(const std::string& path) : csv(endsWith(path, ".csv")) {
+    this->file = std::fopen(path.c_str(), this->csv ? "w" : "wb");
+    if (!this->file) {
+        std::cout << "ERROR::STATS::CANNOT_OPEN_FILE(" << path << ")" << std::endl;
+        return;
+    }
+    if (this->csv) {
+        std::fputs("generation,population,births,deaths,min_x,min_y,max_x,max_y\n", this->file);
+    }
+    else {
+        std::fwrite(STATS_MAGIC, sizeof(STATS_MAGIC), 1, this->file);
+    }
+}
+
+StatsWriter::~StatsWriter() {
+    if (this->file) {
+        std::fclose(this->file);
+    }
+}
+
+void StatsWriter::Write(uint64_t generation, const BoardStats& stats) {
+    if (!this->file) {
+        return;
+    }
+    if (this->csv) {
+        // an empty board has no box
+        if (stats.population > 0) {
+            std::fprintf(this->file, "%llu,%llu,%llu,%llu,%u,%u,%u,%u\n", (unsigned long long)generation,
+                (unsigned long long)stats.population, (unsigned long long)stats.births, (unsigned long long)stats.deaths,
+                stats.minX, stats.minY, stats.maxX, stats.maxY);
+        }
+        else {
+            std::fprintf(this->file, "%llu,0,%llu,%llu,,,,\n", (unsigned long long)generation,
+                (unsigned long long)stats.births, (unsigned long long)stats.deaths);
+        }
+    }
+    else {
+        const StatsRecord record = { generation, stats.population, stats.births, stats.deaths,
+            stats.minX, stats.minY, stats.maxX, stats.maxY };
+        std::fwrite(&record, sizeof(record), 1, this->file);
+    }
+    this->records++;
+}
@@ -0,0 +1,100 @@
+#include "TerminalMode.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <BitGrid.h>
+#include <CheckpointWriter.h>
+#include <LifeEngine.h>
+#include <RandomGenerator.h>
+#include <StatsWriter.h>
+#include <TerminalRenderer.h>
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int) {
+        stopRequested = 1;
+    }
+}
+
+int RunTerminal(const AppConfig& config) {
+    uint64_t generation = 0;
+    BitGrid grid(config.boardWidth, config.boardHeight);
+    if (!config.resumeFrom.empty()) {
+        GridSnapshot checkpoint;
+        if (!CheckpointWriter::Load(config.resumeFrom, checkpoint)) {
+            return -1;
+        }
+        grid = std::move(checkpoint.grid);
+        generation = checkpoint.generation;
+    }
+    else {
+        RandomGenerator rng = config.seed ? RandomGenerator(config.seed) : RandomGenerator();
+        rng.fillGridWithNoise(grid);
+    }
+
+    // outlives the engine, whose simulation thread writes to it
+    std::unique_ptr<StatsWriter> statsWriter;
+    if (!config.statsPath.empty()) {
+        statsWriter = std::make_unique<StatsWriter>(config.statsPath);
+    }
+
+    LifeEngine engine(grid, generation, config.generationsPerSecond, config.maxCatchUp, [](uint64_t, bool) { return false; });
+    engine.SetBoundary(config.boundary);
+    if (config.growBoard) {
+        engine.SetGrowth(BoardGrowth(config.shrinkBoard));
+    }
+    if (config.cycleAction != CycleAction::Off) {
+        engine.DetectCycles(config.cycleAction != CycleAction::Report);
+    }
+    if (statsWriter) {
+        engine.CollectStats([&statsWriter](uint64_t statsGeneration, const BoardStats& stats) { statsWriter->Write(statsGeneration, stats); });
+    }
+    engine.Start();
+    std::signal(SIGINT, requestStop);
+
+    const auto frameInterval = std::chrono::duration<double>(1.0 / config.terminalFps);
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t bytesWritten = 0, frames = 0;
+    {
+        TerminalRenderer renderer;
+        auto nextFrame = start;
+        bool first = true;
+        while (!stopRequested) {
+            // a slow link only delays the next frame; the engine keeps going and the
+            // frame after it shows whatever is newest
+            if (engine.TakeLatest() || first) {
+                const EngineFrame& latest = engine.Latest();
+                std::string status = "generation " + std::to_string(latest.generation) + "  population "
+                    + std::to_string(latest.grid.Population()) + "  " + std::to_string(latest.grid.Width()) + "x"
+                    + std::to_string(latest.grid.Height());
+                if (latest.period > 0) {
+                    status += "  repeats with period " + std::to_string(latest.period);
+                }
+                status += "  Ctrl+C quits";
+                renderer.Draw(latest.grid, status);
+                first = false;
+            }
+            nextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameInterval);
+            const auto now = std::chrono::steady_clock::now();
+            if (nextFrame < now) {
+                nextFrame = now;
+            }
+            std::this_thread::sleep_until(nextFrame);
+        }
+        bytesWritten = renderer.BytesWritten();
+        frames = renderer.Frames();
+    }
+    engine.Stop();
+    std::signal(SIGINT, SIG_DFL);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Terminal: %llu frames in %.1f s, %.1f KiB/frame, %.1f KiB/s\n", (unsigned long long)frames, seconds,
+        frames ? double(bytesWritten) / frames / 1024.0 : 0.0, seconds > 0.0 ? double(bytesWritten) / seconds / 1024.0 : 0.0);
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include "TerminalRenderer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <Trace.h>
+
+namespace {
+    // braille dot bits by (column, row) inside a glyph, see U+2800
+    const uint8_t BRAILLE_DOTS[4][2] = {
+        { 0x01, 0x08 },
+        { 0x02, 0x10 },
+        { 0x04, 0x20 },
+        { 0x40, 0x80 },
+    };
+
+    // number of set bits in [begin, end)
+    uint32_t countBits(const uint64_t* words, size_t begin, size_t end) {
+        const size_t first = begin / 64, last = (end - 1) / 64;
+        uint32_t count = 0;
+        for (size_t i = first; i <= last; i++) {
+            uint64_t word = words[i];
+            if (i == first) {
+                word &= ~0ull << (begin % 64);
+            }
+            if (i == last && end % 64 != 0) {
+                word &= ~0ull >> (64 - end % 64);
+            }
+            count += uint32_t(std::popcount(word));
+        }
+        return count;
+    }
+}
+
+TerminalRenderer::TerminalRenderer() {
+#ifdef _WIN32
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(console, &mode)) {
+        SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    this->frame = "\x1b[?1049h\x1b[?25l";
+    writeFrame();
+}
+
+TerminalRenderer::~TerminalRenderer() {
+    this->frame = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    writeFrame();
+}
+
+void TerminalRenderer::Draw(const BitGrid& grid, const std::string& status) {
+    TRACE_ZONE("TerminalRenderer::Draw");
+    this->frame.clear();
+    if (querySize()) {
+        // a cleared screen shows nothing, which is what shown now says
+        this->frame += "\x1b[2J";
+        this->shown.assign(this->columns * (this->rows - 1), 0);
+        this->shownStatus.clear();
+    }
+
+    rasterize(grid);
+
+    const size_t glyphRows = this->rows - 1;
+    for (size_t row = 0; row < glyphRows; row++) {
+        const uint8_t* current = this->glyphs.data() + row * this->columns;
+        uint8_t* onScreen = this->shown.data() + row * this->columns;
+        size_t column = 0;
+        while (column < this->columns) {
+            if (current[column] == onScreen[column]) {
+                column++;
+                continue;
+            }
+            // one escape per run, bridging short stretches of unchanged glyphs
+            appendCursor(row, column);
+            size_t end = column + 1;
+            size_t lastChanged = column;
+            while (end < this->columns && end - lastChanged <= MAX_GAP + 1) {
+                if (current[end] != onScreen[end]) {
+                    lastChanged = end;
+                }
+                end++;
+            }
+            for (size_t i = column; i <= lastChanged; i++) {
+                appendGlyph(current[i]);
+                onScreen[i] = current[i];
+            }
+            column = lastChanged + 1;
+        }
+    }
+
+    if (status != this->shownStatus) {
+        appendCursor(this->rows - 1, 0);
+        this->frame += "\x1b[7m";
+        this->frame.append(status, 0, std::min(status.size(), this->columns));
+        this->frame += "\x1b[0m\x1b[K";
+        this->shownStatus = status;
+    }
+
+    if (!this->frame.empty()) {
+        writeFrame();
+    }
+    this->frames++;
+}
+
+bool TerminalRenderer::querySize() {
+    size_t columns = 80, rows = 24;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        columns = size_t(info.srWindow.Right - info.srWindow.Left + 1);
+        rows = size_t(info.srWindow.Bottom - info.srWindow.Top + 1);
+    }
+#else
+    winsize size = {};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        columns = size.ws_col;
+        rows = size.ws_row;
+    }
+#endif
+    // keep at least one glyph row above the status line
+    rows = std::max<size_t>(rows, 2);
+    const bool changed = columns != this->columns || rows != this->rows;
+    this->columns = columns;
+    this->rows = rows;
+    return changed;
+}
+
+void TerminalRenderer::rasterize(const BitGrid& grid) {
+    const size_t glyphRows = this->rows - 1;
+    this->glyphs.assign(this->columns * glyphRows, 0);
+    if (grid.Width() == 0 || grid.Height() == 0) {
+        return;
+    }
+
+    // cells per dot, the same along both axes so the board keeps its shape
+    const size_t dotsX = this->columns * 2, dotsY = glyphRows * 4;
+    const size_t scale = std::max<size_t>({ 1, (grid.Width() + dotsX - 1) / dotsX, (grid.Height() + dotsY - 1) / dotsY });
+    const size_t usedDotsX = (grid.Width() + scale - 1) / scale;
+    const size_t usedDotsY = (grid.Height() + scale - 1) / scale;
+
+    const uint32_t threshold = uint32_t(std::max<size_t>(1, scale * scale / 16));
+
+    this->dotCounts.resize(usedDotsX);
+    for (size_t dotY = 0; dotY < usedDotsY; dotY++) {
+        // board row 0 is at the bottom, terminal row 0 at the top
+        const size_t top = grid.Height() - 1 - dotY * scale;
+        const size_t blockRows = std::min(scale, top + 1);
+        std::fill(this->dotCounts.begin(), this->dotCounts.end(), 0);
+        for (size_t i = 0; i < blockRows; i++) {
+            const uint64_t* row = grid.Row(top - i);
+            for (size_t dotX = 0; dotX < usedDotsX; dotX++) {
+                const size_t begin = dotX * scale;
+                this->dotCounts[dotX] += countBits(row, begin, std::min(begin + scale, grid.Width()));
+            }
+        }
+
+        uint8_t* glyphRow = this->glyphs.data() + (dotY / 4) * this->columns;
+        const uint8_t* dots = BRAILLE_DOTS[dotY % 4];
+        for (size_t dotX = 0; dotX < usedDotsX; dotX++) {
+            if (this->dotCounts[dotX] >= threshold) {
+                glyphRow[dotX / 2] |= dots[dotX % 2];
+            }
+        }
+    }
+}
+
+void TerminalRenderer::appendGlyph(uint8_t dots) {
+    // spaces for empty glyphs: one byte instead of three
+    if (dots == 0) {
+        this->frame += ' ';
+        return;
+    }
+    // U+2800 + dots in UTF-8
+    this->frame += char(0xE2);
+    this->frame += char(0xA0 | (dots >> 6));
+    this->frame += char(0x80 | (dots & 0x3F));
+}
+
+void TerminalRenderer::appendCursor(size_t row, size_t column) {
+    char escape[32];
+    const int length = std::snprintf(escape, sizeof(escape), "\x1b[%zu;%zuH", row + 1, column + 1);
+    this->frame.append(escape, size_t(length));
+}
+
+void TerminalRenderer::writeFrame() {
+    TRACE_ZONE("TerminalRenderer::writeFrame");
+#ifdef _WIN32
+    DWORD written = 0;
+    WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), this->frame.data(), DWORD(this->frame.size()), &written, nullptr);
+    this->bytesWritten += written;
+#else
+    // one write per frame; only a full pipe (slow link) splits it
+    size_t offset = 0;
+    while (offset < this->frame.size()) {
+        const ssize_t written = write(STDOUT_FILENO, this->frame.data() + offset, this->frame.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += size_t(written);
+    }
+    this->bytesWritten += offset;
+#endif
+}
@@ -0,0 +1,201 @@
+#include "TextureUploader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <Trace.h>
+
+TextureUploader::TextureUploader(double fullUploadFraction) : fullUploadFraction(fullUploadFraction) {}
+
+TextureUploader::~TextureUploader() {
+    for (Slot& slot : this->slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.PBO);
+    }
+}
+
+void TextureUploader::Upload(const EngineFrame& frame, GLuint texture) {
+    TRACE_ZONE("TextureUploader::Upload");
+    const BitGrid& grid = frame.grid;
+    if (!this->valid || texture != this->uploadedTexture ||
+        grid.Width() != this->uploadedWidth || grid.Height() != this->uploadedHeight) {
+        uploadFull(grid, texture);
+        this->uploadedSequence = frame.sequence;
+        return;
+    }
+    if (frame.sequence == this->uploadedSequence) {
+        return;
+    }
+
+    // scanning in index order also sorts the tiles into rows for run merging
+    this->dirtyTiles.clear();
+    for (size_t tile = 0; tile < frame.tileVersions.size(); tile++) {
+        if (frame.tileVersions[tile] > this->uploadedSequence) {
+            this->dirtyTiles.push_back(uint32_t(tile));
+        }
+    }
+    this->uploadedSequence = frame.sequence;
+    if (this->dirtyTiles.empty()) {
+        return;
+    }
+
+    const size_t tilesX = (grid.Width() + TILE_SIZE - 1) / TILE_SIZE;
+    if (double(this->dirtyTiles.size()) > this->fullUploadFraction * double(frame.tileVersions.size())) {
+        uploadFull(grid, texture);
+    }
+    else {
+        uploadTiles(grid, tilesX, texture);
+    }
+}
+
+void TextureUploader::UploadGrid(const BitGrid& grid, GLuint texture) {
+    TRACE_ZONE("TextureUploader::UploadGrid");
+    uploadFull(grid, texture);
+    // the texture no longer matches any engine frame
+    this->valid = false;
+}
+
+void TextureUploader::uploadFull(const BitGrid& grid, GLuint texture) {
+    const size_t texelsPerRow = grid.WordsPerRow() * 2;
+    const size_t width = grid.Width(), height = grid.Height();
+
+    // BitGrid rows are already the texture rows, no conversion needed
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (texture != this->uploadedTexture || width != this->uploadedWidth || height != this->uploadedHeight) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, GLsizei(texelsPerRow), GLsizei(height), 0, GL_RED_INTEGER, GL_UNSIGNED_INT, grid.Words().data());
+    }
+    else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLsizei(texelsPerRow), GLsizei(height), GL_RED_INTEGER, GL_UNSIGNED_INT, grid.Words().data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    this->valid = true;
+    this->uploadedTexture = texture;
+    this->uploadedWidth = width;
+    this->uploadedHeight = height;
+    this->stats.uploads++;
+    this->stats.fullUploads++;
+    this->stats.bytesUploaded += grid.Words().size() * sizeof(uint64_t);
+}
+
+void TextureUploader::uploadTiles(const BitGrid& grid, size_t tilesX, GLuint texture) {
+    const size_t height = grid.Height();
+    // a tile is one word, two texels, wide
+    const size_t texelsPerTile = TILE_SIZE / CELLS_PER_TEXEL;
+    const size_t texelsPerRow = grid.WordsPerRow() * 2;
+
+    // merge horizontally adjacent tiles into runs, one upload each
+    this->regions.clear();
+    size_t bytes = 0;
+    for (size_t i = 0; i < this->dirtyTiles.size();) {
+        const size_t first = this->dirtyTiles[i];
+        size_t last = first;
+        i++;
+        while (i < this->dirtyTiles.size() && this->dirtyTiles[i] == last + 1 && (last + 1) % tilesX != 0) {
+            last = this->dirtyTiles[i];
+            i++;
+        }
+        Region region;
+        region.x = (first % tilesX) * texelsPerTile;
+        region.y = (first / tilesX) * TILE_SIZE;
+        region.width = (last - first + 1) * texelsPerTile;
+        region.height = std::min(height - region.y, TILE_SIZE);
+        region.offset = bytes;
+        bytes += region.width * region.height * sizeof(uint32_t);
+        this->regions.push_back(region);
+    }
+
+    const size_t tileCount = tilesX * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    const size_t capacity = size_t(this->fullUploadFraction * double(tileCount)) * TILE_SIZE * TILE_SIZE / 8;
+    if (this->slotBytes < bytes) {
+        createBuffers(std::max(bytes, capacity));
+    }
+
+    // never wait for the GPU: if the next buffer is still being read, upload from the board directly
+    Slot& slot = this->slots[this->nextSlot];
+    bool buffered = true;
+    if (slot.fence) {
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            buffered = false;
+        }
+        else {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+    }
+
+    uint8_t* target = nullptr;
+    if (buffered) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.PBO);
+        // the fence guarantees the GPU is done with this buffer, so no implicit sync is needed
+        target = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(bytes),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!target) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            buffered = false;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (buffered) {
+        for (const Region& region : this->regions) {
+            const size_t rowBytes = region.width * sizeof(uint32_t);
+            for (size_t y = 0; y < region.height; y++) {
+                const uint32_t* row = reinterpret_cast<const uint32_t*>(grid.Row(region.y + y));
+                std::memcpy(target + region.offset + y * rowBytes, row + region.x, rowBytes);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        // with an unpack buffer bound the pointer argument is an offset into it
+        for (const Region& region : this->regions) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height),
+                GL_RED_INTEGER, GL_UNSIGNED_INT, reinterpret_cast<const void*>(region.offset));
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        this->nextSlot = (this->nextSlot + 1) % SLOTS;
+    }
+    else {
+        // straight from the board; the driver copies it before returning
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(texelsPerRow));
+        for (const Region& region : this->regions) {
+            const uint32_t* row = reinterpret_cast<const uint32_t*>(grid.Row(region.y));
+            glTexSubImage2D(GL_TEXTURE_2D, 0, GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height),
+                GL_RED_INTEGER, GL_UNSIGNED_INT, row + region.x);
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        this->stats.unbufferedUploads++;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    this->stats.uploads++;
+    this->stats.tilesUploaded += this->dirtyTiles.size();
+    this->stats.bytesUploaded += bytes;
+}
+
+void TextureUploader::createBuffers(size_t bytes) {
+    for (Slot& slot : this->slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (!slot.PBO) {
+            glGenBuffers(1, &slot.PBO);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.PBO);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(bytes), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    this->slotBytes = bytes;
+}
+
+void TextureUploader::PrintStats() const {
+    const UploadStats& s = this->stats;
+    std::printf("Texture uploads: %llu (%llu full), %llu tiles, %.1f MiB, %llu without a free pixel buffer\n",
+        (unsigned long long)s.uploads, (unsigned long long)s.fullUploads, (unsigned long long)s.tilesUploaded,
+        double(s.bytesUploaded) / (1024.0 * 1024.0), (unsigned long long)s.unbufferedUploads);
+}
@@ -0,0 +1,143 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{ false };
+
+namespace {
+    const size_t EVENTS_PER_THREAD = 1 << 16;   // power of two, oldest events are overwritten
+
+    struct Event {
+        const char* name;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    // written only by its owning thread; head is published with release so a reader
+    // that acquires it sees every event before it
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::string threadName;
+        std::unique_ptr<Event[]> events{ new Event[EVENTS_PER_THREAD] };
+        std::atomic<uint64_t> head{ 0 };
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> registry;
+    uint32_t nextThreadId = 1;
+
+    thread_local std::shared_ptr<ThreadBuffer> currentBuffer;
+    thread_local std::string currentThreadName;
+
+    // created on the first recorded event, so threads that never trace never allocate.
+    // Buffers stay registered after their thread exits so late dumps still include them.
+    ThreadBuffer& threadBuffer() {
+        if (!currentBuffer) {
+            currentBuffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            currentBuffer->threadId = nextThreadId++;
+            currentBuffer->threadName = currentThreadName;
+            registry.push_back(currentBuffer);
+        }
+        return *currentBuffer;
+    }
+
+    void writeEscaped(std::ostream& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+    }
+}
+
+void Trace::SetEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+uint64_t Trace::NowNanoseconds() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Trace::Record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    const uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[index & (EVENTS_PER_THREAD - 1)] = Event{ name, startNs, endNs };
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::SetThreadName(const char* name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    currentThreadName = name;
+    if (currentBuffer) {
+        currentBuffer->threadName = name;
+    }
+}
+
+bool Trace::WriteChromeJson(const std::string& path) {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers = registry;
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    size_t written = 0;
+    std::vector<Event> events;
+    for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            if (!buffer->threadName.empty()) {
+                file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"args\":{\"name\":\"";
+                writeEscaped(file, buffer->threadName);
+                file << "\"}}";
+                first = false;
+            }
+        }
+
+        // copy the ring, then drop anything the owner may have overwritten while we copied,
+        // including the slot of event headAfter, which it may be writing right now
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t begin = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            events.push_back(buffer->events[i & (EVENTS_PER_THREAD - 1)]);
+        }
+        const uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+        const uint64_t firstValid = headAfter + 1 > EVENTS_PER_THREAD ? headAfter + 1 - EVENTS_PER_THREAD : 0;
+
+        for (uint64_t i = begin; i < head; i++) {
+            if (i < firstValid) {
+                continue;
+            }
+            const Event& event = events[size_t(i - begin)];
+            file << (first ? "" : ",\n") << "{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << (event.endNs - event.startNs) / 1000.0 << "}";
+            first = false;
+            written++;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        std::cout << "ERROR::TRACE::WRITE_FAILED(" << path << ")" << std::endl;
+        return false;
+    }
+    std::cout << "Trace: wrote " << written << " events to " << path << std::endl;
+    return true;
+}
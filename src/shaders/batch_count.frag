@@ -0,0 +1,38 @@
+#version 330 core
+
+// First half of the per-board population reduction of batch_step.frag's boards: counts the
+// live cells of all 128 boards in a segment of COUNT_SEGMENT cells of one row. The counts are
+// bit-sliced like the boards, bit b of plane k being bit k of the count of board b, so the
+// adding runs 128 boards at a time. The planes are the layers of one texture array.
+
+layout(location = 0) out uvec4 Planes[8];
+
+uniform usampler2D boards;
+uniform ivec2 gridSize;
+
+// 8 planes count up to 255
+const int COUNT_SEGMENT = 128;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	int first = texel.x * COUNT_SEGMENT;
+	int last = min(first + COUNT_SEGMENT, gridSize.x);
+
+	uvec4 planes[8];
+	for (int k = 0; k < 8; k++) {
+		planes[k] = uvec4(0u);
+	}
+	for (int x = first; x < last; x++) {
+		// ripple the cells in as a carry
+		uvec4 carry = texelFetch(boards, ivec2(x, texel.y), 0);
+		for (int k = 0; k < 8; k++) {
+			uvec4 next = planes[k] & carry;
+			planes[k] ^= carry;
+			carry = next;
+		}
+	}
+	for (int k = 0; k < 8; k++) {
+		Planes[k] = planes[k];
+	}
+}
@@ -0,0 +1,55 @@
+#version 330 core
+
+// Steps 128 independent boards at once. Every texel holds the same cell of all of them:
+// bit b of component c is board 32 * c + b. The neighbour count is done with bit-sliced
+// adders on whole uvec4s, the same as LifeRule::NextWord does on words of 64 cells, so one
+// fragment runs the rule for 128 cells. The boards have no halo: BoardBatchShader defines one
+// BOUNDARY_* (see Boundary.h) and cell() maps neighbours beyond the edge back onto the board,
+// except for BOUNDARY_DEAD, where the outermost ring is forced dead as in simulation.frag.
+
+layout(location = 0) out uvec4 Next;
+
+uniform usampler2D boards;
+uniform ivec2 gridSize;			   // (width, height) of every board
+
+uvec4 cell(ivec2 texel) {
+#if defined(BOUNDARY_TORUS)
+	texel = (texel + gridSize) % gridSize;
+#elif defined(BOUNDARY_KLEIN)
+	if (texel.y < 0 || texel.y >= gridSize.y) {
+		texel = ivec2(gridSize.x - 1 - texel.x, (texel.y + gridSize.y) % gridSize.y);
+	}
+	texel.x = (texel.x + gridSize.x) % gridSize.x;
+#elif defined(BOUNDARY_MIRROR)
+	texel = clamp(texel, ivec2(0), gridSize - 1);
+#endif
+	return texelFetch(boards, texel, 0);
+}
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+#ifdef BOUNDARY_DEAD
+	if (texel.x == 0 || texel.y == 0 || texel.x == gridSize.x - 1 || texel.y == gridSize.y - 1) {
+		Next = uvec4(0u);
+		return;
+	}
+#endif
+
+	uvec4 nw = cell(texel + ivec2(-1, 1)), n = cell(texel + ivec2(0, 1)), ne = cell(texel + ivec2(1, 1));
+	uvec4 w = cell(texel + ivec2(-1, 0)), c = cell(texel), e = cell(texel + ivec2(1, 0));
+	uvec4 sw = cell(texel + ivec2(-1, -1)), s = cell(texel + ivec2(0, -1)), se = cell(texel + ivec2(1, -1));
+
+	// add the eight neighbour bits into ones/twos/fours with full adders
+	uvec4 s0 = nw ^ n ^ ne, c0 = (nw & n) | ((nw ^ n) & ne);
+	uvec4 s1 = w ^ e ^ sw, c1 = (w & e) | ((w ^ e) & sw);
+	uvec4 s2 = s ^ se, c2 = s & se;
+
+	uvec4 ones = s0 ^ s1 ^ s2, carryOnes = (s0 & s1) | ((s0 ^ s1) & s2);
+	uvec4 t2 = c0 ^ c1 ^ c2, fourA = (c0 & c1) | ((c0 ^ c1) & c2);
+	uvec4 twos = t2 ^ carryOnes, fourB = t2 & carryOnes;
+	uvec4 fours = fourA | fourB;
+
+	// 3 neighbours -> alive, 2 neighbours -> unchanged, anything else -> dead
+	Next = twos & ~fours & (ones | c);
+}
@@ -0,0 +1,33 @@
+#version 330 core
+
+// Second half of the population reduction: one fragment per board and band of SUM_ROWS rows
+// takes that board's bit out of the segment counts of batch_count.frag and adds them up.
+// Fragment x is board x % 128 of the batch texture being reduced; the CPU adds up the bands.
+
+layout(location = 0) out int Population;
+
+uniform usampler2DArray planes;
+uniform ivec2 gridSize;
+uniform int segments;
+
+const int SUM_ROWS = 16;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	int board = texel.x % 128;
+	int component = board / 32;
+	uint bit = uint(board % 32);
+	int first = texel.y * SUM_ROWS;
+	int last = min(first + SUM_ROWS, gridSize.y);
+
+	int population = 0;
+	for (int y = first; y < last; y++) {
+		for (int segment = 0; segment < segments; segment++) {
+			for (int k = 0; k < 8; k++) {
+				population += int((texelFetch(planes, ivec3(segment, y, k), 0)[component] >> bit) & 1u) << k;
+			}
+		}
+	}
+	Population = population;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Packs 32 cells of a simulation tile into one uint so readbacks move 1 bit per cell.
+// Bit i of texel (x, y) holds tile cell (x * 32 + i, y), matching BitGrid's word layout.
+
+out uint PackedBits;
+
+uniform sampler2D currentState;    // current tile, interior cells start at texel (1, 1)
+uniform ivec2 gridSize;			   // tile (width, height)
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	int firstCell = texel.x * 32;
+
+	uint bits = 0u;
+	for (int i = 0; i < 32; i++) {
+		int x = firstCell + i;
+		if (x < gridSize.x && texelFetch(currentState, ivec2(x, texel.y) + 1, 0).r > .5) {
+			bits |= 1u << uint(i);
+		}
+	}
+
+	PackedBits = bits;
+}
@@ -3,8 +3,26 @@ out vec4 FragColor;
 
 in vec2 TexCoord;
 
-uniform sampler2D currentState;    // current grid
+uniform sampler2D currentState;    // current simulation tile, with a one cell halo
 uniform ivec2 gridSize;			   // (width, height)
+uniform ivec2 tileOrigin;          // board position of the tile's first interior cell
+uniform usampler2D packedState;    // current grid with 32 cells per texel, bit x % 32 of texel x / 32
+uniform bool usePackedState;       // read packedState instead of currentState
+
+// camera: board cell at the bottom-left window corner, cells spanned by the window
+uniform vec2 viewOrigin;
+uniform vec2 viewSize;
+uniform float cellsPerPixel;
+
+// zoomed out, cells are drawn as a density heatmap from a mip pyramid: either the density
+// pyramid (level l = 8 << l cell blocks) or, without it, the mipmaps of the tile
+uniform sampler2D densityPyramid;
+uniform bool useDensityPyramid;
+
+// age mode: live cells take their colour from agePalette (256 x 1) indexed by the tile's age
+uniform sampler2D ageState;
+uniform sampler2D agePalette;
+uniform bool useAgePalette;
 
 int GetCellState(ivec2 pos) {
 	//pos = ivec2(mod(vec2(pos), vec2(gridSize))); // wrapping
@@ -13,6 +31,30 @@ int GetCellState(ivec2 pos) {
 	return state > .5 ? 1 : 0;
 }
 
+float CellValue(ivec2 cell) {
+	if (usePackedState) {
+		uint texel = texelFetch(packedState, ivec2(cell.x >> 5, cell.y), 0).r;
+		return float((texel >> uint(cell.x & 31)) & 1u);
+	}
+	return texelFetch(currentState, cell - tileOrigin + 1, 0).r;
+}
+
+vec3 AgeColor(ivec2 cell) {
+	int age = int(texelFetch(ageState, cell - tileOrigin + 1, 0).r * 255.0 + 0.5);
+	return texelFetch(agePalette, ivec2(age, 0), 0).rgb;
+}
+
+float Density(vec2 cellPos) {
+	float lod = log2(cellsPerPixel);
+	if (useDensityPyramid) {
+		// the pyramid's base level is padded to whole 64-cell tiles
+		vec2 pyramidCells = vec2(textureSize(densityPyramid, 0)) * 8.0;
+		return textureLod(densityPyramid, cellPos / pyramidCells, lod - 3.0).r;
+	}
+	vec2 tileCell = cellPos - vec2(tileOrigin) + 1.0;
+	return textureLod(currentState, tileCell / vec2(textureSize(currentState, 0)), lod).r;
+}
+
 void main()
 {
 	vec3 _color = vec3(0.361, 0.89, 0.82);
@@ -30,7 +72,24 @@ void main()
 
 	// //int cellState = GetCellState(pos);
 
-	float s = texture(currentState, TexCoord).r;
+	vec2 cellPos = viewOrigin + TexCoord * viewSize;
+	if (any(lessThan(cellPos, vec2(0.0))) || any(greaterThanEqual(cellPos, vec2(gridSize)))) {
+		FragColor = vec4(0.05, 0.05, 0.07, 1.0f);
+		return;
+	}
+
+	float s;
+	if (cellsPerPixel <= 1.0) {
+		s = CellValue(ivec2(cellPos));
+		if (useAgePalette && s > .5) {
+			FragColor = vec4(AgeColor(ivec2(cellPos)), 1.0f);
+			return;
+		}
+	}
+	else {
+		// sqrt keeps sparse regions visible
+		s = sqrt(Density(cellPos));
+	}
 
     FragColor = vec4(s * _color, 1.0f);
 }
\ No newline at end of file
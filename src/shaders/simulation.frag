@@ -1,25 +1,36 @@
 #version 330 core
 
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
 
 in vec3 FragPos;
 in vec2 TexCoord;
 
-uniform sampler2D currentState;    // current grid
+// SimulationShader defines one BOUNDARY_* (see Boundary.h). Every mode but BOUNDARY_DEAD only
+// changes what exchangeHalos puts into the halos on the board's edges, so this shader just
+// steps the edge cells like any other.
+
+uniform sampler2D currentState;    // current tile with a one cell halo of its neighbours' edges
 uniform ivec2 gridSize;			   // (width, height)
+uniform ivec2 tileOrigin;          // board position of the tile's first interior cell
+
+#ifdef TRACK_AGE
+// generations each live cell has survived / 255, saturating; 0 for dead cells
+uniform sampler2D currentAge;
+layout(location = 1) out float Age;
+#endif
 
-int GetCellState(ivec2 pos) {
-	float state = texture(currentState, vec2(pos) / vec2(gridSize)).r;
+int GetCellState(ivec2 texel) {
+	float state = texelFetch(currentState, texel, 0).r;
 	return state > .5 ? 1 : 0;
 }
 
-int GetLiveNeighborCount(ivec2 pos) {
+int GetLiveNeighborCount(ivec2 texel) {
 	int liveNeighbors = 0;
 
 	for (int xOffset = -1; xOffset < 2; xOffset++) {
 		for (int yOffset = -1; yOffset < 2; yOffset++) {
-			if (xOffset == 0 || yOffset == 0) continue;
-			int neighborState = GetCellState(pos + ivec2(xOffset, yOffset));
+			if (xOffset == 0 && yOffset == 0) continue;
+			int neighborState = GetCellState(texel + ivec2(xOffset, yOffset));
 			liveNeighbors += neighborState;
 		}
 	}
@@ -28,17 +39,24 @@ int GetLiveNeighborCount(ivec2 pos) {
 
 void main()
 {
-	ivec2 pos = ivec2(TexCoord.x * gridSize.x, TexCoord.y * gridSize.y);
+	// the viewport covers the tile's interior, texels 1..size
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	ivec2 pos = tileOrigin + texel - 1;
 
+#ifdef BOUNDARY_DEAD
 	if (pos.x == 0 || pos.y == 0 || pos.x == gridSize.x - 1|| pos.y == gridSize.y - 1) {
 		FragColor = vec4(vec3(0), 1.0f);
+#ifdef TRACK_AGE
+		Age = 0.0;
+#endif
 		return;
 	}
+#endif
 
-	int cellState = GetCellState(pos);
+	int cellState = GetCellState(texel);
 	int newState = cellState;
 
-	int neighborCount = GetLiveNeighborCount(pos);
+	int neighborCount = GetLiveNeighborCount(texel);
 	if (cellState == 1) {
 		if (neighborCount < 2 || neighborCount > 3) {
 			newState = 0;
@@ -51,4 +69,8 @@ void main()
 	}
 
     FragColor = vec4(vec3(newState), 1.0f);
-}
\ No newline at end of file
+#ifdef TRACK_AGE
+	// dead cells are 0, so births start at one generation
+	Age = newState == 1 ? min(texelFetch(currentAge, texel, 0).r + 1.0 / 255.0, 1.0) : 0.0;
+#endif
+}
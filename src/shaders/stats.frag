@@ -0,0 +1,41 @@
+#version 330 core
+
+// Reduces a block of STATS_BLOCK x STATS_BLOCK cells of a simulation tile to one texel of
+// counts and one of bounds; the CPU adds up the few blocks. Births and deaths compare the
+// tile against its previous generation, which is still in the other ping-pong texture.
+
+layout(location = 0) out ivec4 Counts;    // population, births, deaths, 0
+layout(location = 1) out ivec4 Bounds;    // inclusive min x, min y, max x, max y on the board, -1 when empty
+
+uniform sampler2D currentState;    // current tile, interior cells start at texel (1, 1)
+uniform sampler2D previousState;   // the tile one generation earlier
+uniform ivec2 tileSize;
+uniform ivec2 tileOrigin;
+
+const int STATS_BLOCK = 32;
+
+void main()
+{
+	ivec2 first = ivec2(gl_FragCoord.xy) * STATS_BLOCK;
+	ivec2 last = min(first + STATS_BLOCK, tileSize);
+
+	int population = 0, births = 0, deaths = 0;
+	ivec2 low = tileSize, high = ivec2(-1);
+	for (int y = first.y; y < last.y; y++) {
+		for (int x = first.x; x < last.x; x++) {
+			ivec2 cell = ivec2(x, y);
+			bool alive = texelFetch(currentState, cell + 1, 0).r > .5;
+			bool was = texelFetch(previousState, cell + 1, 0).r > .5;
+			if (alive) {
+				population++;
+				low = min(low, cell);
+				high = max(high, cell);
+			}
+			births += int(alive && !was);
+			deaths += int(was && !alive);
+		}
+	}
+
+	Counts = ivec4(population, births, deaths, 0);
+	Bounds = population > 0 ? ivec4(low + tileOrigin, high + tileOrigin) : ivec4(-1);
+}
@@ -0,0 +1,110 @@
+// Standalone checks for HistoryRecorder's file handling; exits non-zero if any check fails.
+// Build from the repository root, e.g.
+//   g++ -std=c++20 -Iinclude -ILibraries/include tests/HistoryRecorderTest.cpp src/HistoryRecorder.cpp
+//       src/DeltaCodec.cpp src/BitGrid.cpp src/LifeRule.cpp src/Trace.cpp -lpthread
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <HistoryRecorder.h>
+#include <LifeRule.h>
+
+namespace {
+    // an unusual size, so the frame headers can be found in the file without knowing its layout
+    const uint32_t WIDTH = 333, HEIGHT = 177;
+    const char* PATH = "history_test.golhist";
+
+    int failures = 0;
+
+    void check(bool condition, const char* what) {
+        if (!condition) {
+            std::cout << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    std::vector<char> readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeFile(const std::string& path, const std::vector<char>& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), std::streamsize(bytes.size()));
+    }
+
+    // offsets of the width of every frame header in the file
+    std::vector<size_t> findFrameSizes(const std::vector<char>& bytes) {
+        const uint32_t size[2] = { WIDTH, HEIGHT };
+        std::vector<size_t> offsets;
+        for (size_t i = 0; i + sizeof(size) <= bytes.size(); i++) {
+            if (std::memcmp(bytes.data() + i, size, sizeof(size)) == 0) {
+                offsets.push_back(i);
+            }
+        }
+        return offsets;
+    }
+
+    // gives every frame the same size, so only the size check itself can catch it
+    std::vector<char> withFrameSize(const std::vector<char>& bytes, uint32_t width, uint32_t height) {
+        std::vector<char> corrupt = bytes;
+        for (size_t offset : findFrameSizes(bytes)) {
+            std::memcpy(corrupt.data() + offset, &width, sizeof(width));
+            std::memcpy(corrupt.data() + offset + sizeof(width), &height, sizeof(height));
+        }
+        return corrupt;
+    }
+
+    // a corrupted copy of the recording must be refused without touching the recorder's frames
+    void checkRejected(const std::vector<char>& bytes, const char* what) {
+        writeFile(PATH, bytes);
+        HistoryRecorder loaded(1);
+        check(!loaded.Load(PATH) && loaded.Empty(), what);
+    }
+}
+
+int main() {
+    BitGrid grid(WIDTH, HEIGHT), next;
+    for (uint32_t i = 0; i < 4000; i++) {
+        grid.Set((i * 37) % WIDTH, (i * 11) % HEIGHT, true);
+    }
+    std::vector<BitGrid> boards;
+    HistoryRecorder loaded(1);
+    GridSnapshot snapshot;
+    {
+        HistoryRecorder recorder(4, PATH);
+        for (uint64_t generation = 0; generation < 10; generation++) {
+            boards.push_back(grid);
+            recorder.Record(std::make_shared<const GridSnapshot>(GridSnapshot{ generation, grid }));
+            LifeRule::Step(grid, next, Boundary::Dead);
+            grid = next;
+        }
+        // still open, as after a crash: everything up to the last keyframe (8) is on disk
+        check(loaded.Load(PATH) && loaded.LastGeneration() >= 8, "load a recording that is still being written");
+    }
+    const std::vector<char> bytes = readFile(PATH);
+
+    check(loaded.Load(PATH) && loaded.FirstGeneration() == 0 && loaded.LastGeneration() == 9, "load an intact file");
+    check(loaded.Seek(7, snapshot) && snapshot.generation == 7 && snapshot.grid == boards[7], "seek after load");
+
+    check(findFrameSizes(bytes).size() == boards.size(), "find every frame header");
+    checkRejected(withFrameSize(bytes, 0xffffffffu, HEIGHT), "reject frames wider than --size allows");
+    checkRejected(withFrameSize(bytes, WIDTH, 0xffffffffu), "reject frames taller than --size allows");
+    checkRejected(withFrameSize(bytes, 2, HEIGHT), "reject frames narrower than --size allows");
+
+    // a frame cut short is left out, the ones before it still load
+    writeFile(PATH, std::vector<char>(bytes.begin(), bytes.end() - 1));
+    check(loaded.Load(PATH) && loaded.LastGeneration() == 8 && loaded.Seek(9, snapshot) && snapshot.grid == boards[8],
+        "load a file that ends inside a frame");
+
+    std::remove(PATH);
+    if (failures == 0) {
+        std::cout << "HistoryRecorderTest: all checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}